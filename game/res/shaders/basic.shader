@@ -1,10 +1,13 @@
 #shader vertex
 #version 330 core
 
+#include "include/frame.glsl"
+#include "include/object.glsl"
+
 layout(location = 0) in vec4 position;
 
 void main() {
-    gl_Position = position;
+    gl_Position = u_ViewProjection * u_Model * position;
 };
 
 #shader fragment
@@ -24,4 +27,5 @@ void main() {
  * layout(location = 0) refers to attributeIndex
  * We need to use vec4, even though we're drawing a vec2. OpenGL will cast it
  * In fragmentShader, color is an rgba
+ * #include is resolved by ShaderPreprocessor, relative to this file
  */
\ No newline at end of file
@@ -0,0 +1,6 @@
+/* Shared by every program and uploaded once per frame. Mirrored by FrameConstants in UniformBlocks.h */
+layout(std140) uniform FrameConstants {
+	mat4 u_ViewProjection;
+	float u_Time;
+	float u_DeltaTime;
+};
@@ -0,0 +1,4 @@
+/* Per-draw data, a range of Renderer's ring buffer. Mirrored by ObjectConstants in UniformBlocks.h */
+layout(std140) uniform ObjectConstants {
+	mat4 u_Model;
+};
@@ -12,6 +12,14 @@
 #include "VertexArray.h"
 
 #include "Shader.h"
+#include "ShaderLibrary.h"
+#include "ResourceRegistry.h"
+#include "DrawList.h"
+#include "EntityWorld.h"
+#include "FrameAllocator.h"
+#include "JobSystem.h"
+#include "Matrix.h"
+#include "generated/ShaderBindings.h"
 
 int main(void) {
 	GLFWwindow* window;
@@ -49,6 +57,8 @@ int main(void) {
 	 * When there's no gl context, GLClearError generates an error. This causes an infinite loop.
 	 * Putting a scope around the class use causes them to be deleted before the gl context is deleted.
 	 * Normally, we'd allocate these classes on the heap, so the problem would go away.
+	 * The wrappers' destructors now only queue their objects (see DeletionQueue), and the queue is flushed after
+	 * this scope while the context still exists. The scope decides when that flush has everything.
 	 */
 	{
 		/* This is all Vertex data. Positions in this case, but will contain other data normally.
@@ -66,31 +76,67 @@ int main(void) {
 			2, 3, 0
 		};
 
-		VertexArray va;
-		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+		/* Owns the GL objects, everything else refers to them by handle */
+		ResourceRegistry resources;
+		ResourceHandle<VertexArray> va = resources.Create<VertexArray>();
+		ResourceHandle<VertexBuffer> vb = resources.Create<VertexBuffer>(positions, 4 * 2 * sizeof(float));
 		VertexBufferLayout layout;
 		layout.Push<float>(2);
-		va.AddBuffer(vb, layout);
-
-		IndexBuffer ib(indices, 6);
-
-		Shader shader("res/shaders/basic.shader");
-		shader.Bind();
-		shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+		resources.Get(va)->AddBuffer(*resources.Get(vb), layout);
+
+		ResourceHandle<IndexBuffer> ib = resources.Create<IndexBuffer>(indices, 6);
+
+		/* Worker threads for everything that can go wide. This thread is one of them while it waits on jobs */
+		JobSystem jobs;
+
+		/* Compiles each distinct program once and shares it.
+		 * Built in shaders come from the executable, so startup doesn't read res/shaders at all */
+		ShaderLibrary shaders(resources);
+		shaders.SetJobSystem(&jobs);
+		shaders.PreWarmEmbedded();
+		ResourceHandle<Shader> shader = shaders.Get("res/shaders/basic.shader");
+		/* Null if it didn't build, the reason is in the log */
+		ASSERT(!shader.IsNull());
+		/* Interned once here so the render loop sets it without touching a string */
+		UniformID colorUniform(BasicShader::COLOR_UNIFORM);
+		ResourceHandle<Material> material = resources.Create<Material>(resources, shader);
+		resources.Get(material)->SetUniform4f(colorUniform, 0.2f, 0.3f, 0.8f, 1.0f);
 		
 		// eg code: unbind everything
-		va.Unbind();
-		vb.Unbind();
-		ib.Unbind();
-		shader.Unbind();
+		resources.Get(va)->Unbind();
+		resources.Get(vb)->Unbind();
+		resources.Get(ib)->Unbind();
+		resources.Get(shader)->Unbind();
 		
 		Renderer renderer;
 
+		/* Two units tall and as wide as the window, so the square stays square at 640x480 */
+		const float aspect = 640.0f / 480.0f;
+		FrameConstants frame = {};
+		frame.ViewProjection = Mat4::Orthographic(-aspect, aspect, -1.0f, 1.0f, -1.0f, 1.0f).ToStd140();
+
+		/* The square is an entity. Each frame the draw list pulls everything renderable out of the world,
+		 * culls it and submits what's at least partly in view. Per draw constants go through the renderer's ring buffer */
+		EntityWorld world;
+		world.SetJobSystem(&jobs);
+		/* Half the diagonal, so the box holds the square whichever way it's turned */
+		const float squareMin[] = { -0.7072f, -0.7072f, 0.0f };
+		const float squareMax[] = { 0.7072f, 0.7072f, 0.0f };
+		unsigned int square = world.Create(Transform{ Mat4::Identity() }, MeshRef{ va, ib }, MaterialRef{ material },
+			Bounds{ CullBounds::FromBox(squareMin, squareMax) });
+		FrameAllocator frameAllocator;
+		DrawList drawList(frameAllocator);
+
 		float r = 0.0f;
 		float increment = 0.05;
 		/* Loop until the user closes the window */
 		while (!glfwWindowShouldClose(window)) {
 			/* Render here */
+			float time = (float)glfwGetTime();
+			frame.DeltaTime = time - frame.Time;
+			frame.Time = time;
+			renderer.BeginFrame(frame);
+			frameAllocator.BeginFrame();
 			renderer.Clear();
 
 			/* This is "legacy" OpenGL. It's discouraged but fine for testing. */
@@ -106,13 +152,14 @@ int main(void) {
 			 * - Bind index buffer
 			 * - Draw call
 			 * 
-			 * Ideally, these lines would be abstracted out, but this requires materials.
+			 * The material binds the shader and sets its uniforms, the renderer does the rest.
 			 * Materials = shader + uniforms
 			 */
-			shader.Bind();
-			shader.SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+			resources.Get(material)->SetUniform4f(colorUniform, r, 0.3f, 0.8f, 1.0f);
+			world.Get<Transform>(square).World = Mat4::Rotation(Quat::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, time));
 
-			renderer.Draw(va, ib, shader);
+			drawList.Extract(world, resources, Frustum::FromViewProjection(&frame.ViewProjection.Columns[0].x));
+			drawList.Submit(renderer, resources);
 
 			if (r > 1.0f) {
 				increment = -0.05f;
@@ -123,13 +170,26 @@ int main(void) {
 
 			r += increment;
 
+			renderer.EndFrame();
+
 			/* Swap front and back buffers */
 			glfwSwapBuffers(window);
 
 			/* Poll for and process events */
 			glfwPollEvents();
 		}
+		renderer.Shutdown();
+
+		const UniformStats& uniformStats = Shader::GetUniformStats();
+		std::cout << "Uniform writes: " << uniformStats.Issued << " issued, "
+			<< uniformStats.Skipped << " skipped as redundant" << std::endl;
+		const CullStats& cullStats = drawList.GetStats();
+		std::cout << "Culling: " << cullStats.Tested << " tested, " << cullStats.Visible << " visible, "
+			<< cullStats.Culled << " culled" << std::endl;
 	}
+	DeletionQueue::Flush();
+	const DeletionStats& deletionStats = DeletionQueue::GetStats();
+	std::cout << "GL deletions: " << deletionStats.Objects << " objects in " << deletionStats.Calls << " calls" << std::endl;
 	glfwTerminate();
 	return 0;
 }
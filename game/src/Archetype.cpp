@@ -0,0 +1,83 @@
+#include "Archetype.h"
+
+#include <cstring>
+#include <new>
+
+#include "Renderer.h"
+
+/* Cache line aligned, so the first array of a chunk starts on a line */
+static const size_t CHUNK_ALIGNMENT = 64;
+
+static unsigned int AlignUp(unsigned int value, unsigned int alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+Archetype::Archetype(ComponentMask mask)
+	: m_Mask(mask), m_Count(0) {
+	for (unsigned int type = 0; type < MAX_COMPONENT_TYPES; type++) {
+		m_Offsets[type] = NONE;
+		if (Has(type)) {
+			m_Types.push_back(type);
+		}
+	}
+
+	/* A first guess ignoring alignment padding, then back off until it fits */
+	unsigned int entitySize = sizeof(unsigned int);
+	for (unsigned int type : m_Types) {
+		entitySize += GetComponentTypeInfo(type).Size;
+	}
+	m_Capacity = CHUNK_SIZE / entitySize;
+	while (LayOut(m_Capacity) > CHUNK_SIZE) {
+		m_Capacity--;
+	}
+	ASSERT(m_Capacity > 0);
+	LayOut(m_Capacity);
+}
+
+Archetype::~Archetype() {
+	for (Chunk& chunk : m_Chunks) {
+		operator delete(chunk.Data, std::align_val_t(CHUNK_ALIGNMENT));
+	}
+}
+
+unsigned int Archetype::LayOut(unsigned int capacity) {
+	unsigned int offset = capacity * sizeof(unsigned int);
+	for (unsigned int type : m_Types) {
+		const ComponentTypeInfo& info = GetComponentTypeInfo(type);
+		offset = AlignUp(offset, info.Alignment);
+		m_Offsets[type] = offset;
+		offset += capacity * info.Size;
+	}
+	return offset;
+}
+
+void Archetype::Add(unsigned int entity, unsigned int& chunk, unsigned int& row) {
+	if (m_Chunks.empty() || m_Chunks.back().Count == m_Capacity) {
+		m_Chunks.push_back({ (unsigned char*)operator new(CHUNK_SIZE, std::align_val_t(CHUNK_ALIGNMENT)), 0 });
+	}
+	chunk = (unsigned int)m_Chunks.size() - 1;
+	row = m_Chunks[chunk].Count++;
+	((unsigned int*)m_Chunks[chunk].Data)[row] = entity;
+	m_Count++;
+}
+
+unsigned int Archetype::Remove(unsigned int chunk, unsigned int row) {
+	unsigned int lastChunk = (unsigned int)m_Chunks.size() - 1;
+	unsigned int lastRow = m_Chunks[lastChunk].Count - 1;
+	unsigned int moved = NONE;
+	if (chunk != lastChunk || row != lastRow) {
+		moved = GetEntities(lastChunk)[lastRow];
+		((unsigned int*)m_Chunks[chunk].Data)[row] = moved;
+		for (unsigned int type : m_Types) {
+			memcpy(GetComponent(chunk, row, type), GetComponent(lastChunk, lastRow, type), GetComponentTypeInfo(type).Size);
+		}
+	}
+
+	/* Keeps one spare chunk around when the archetype empties, entities tend to come back */
+	if (--m_Chunks[lastChunk].Count == 0 && lastChunk > 0) {
+		operator delete(m_Chunks[lastChunk].Data, std::align_val_t(CHUNK_ALIGNMENT));
+		m_Chunks.pop_back();
+	}
+	m_Count--;
+	return moved;
+}
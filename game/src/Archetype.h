@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "ComponentType.h"
+
+/* Storage for every entity that has exactly one set of components.
+ * Entities live in fixed size chunks. Within a chunk each component type has its own array, so a query walking
+ * a chunk reads one tightly packed array per component it asked for and nothing else. Chunks stay full except
+ * the last: removing an entity moves the archetype's last entity into the gap.
+ */
+class Archetype {
+public:
+	static const unsigned int CHUNK_SIZE = 16 * 1024;
+	static const unsigned int NONE = 0xffffffff;
+
+private:
+	struct Chunk {
+		unsigned char* Data;
+		unsigned int Count;
+	};
+
+	ComponentMask m_Mask;
+	std::vector<unsigned int> m_Types;
+	/* Byte offset of each type's array within a chunk, by type number. The entity array is at 0 */
+	unsigned int m_Offsets[MAX_COMPONENT_TYPES];
+	unsigned int m_Capacity;
+	std::vector<Chunk> m_Chunks;
+	unsigned int m_Count;
+
+	unsigned int LayOut(unsigned int capacity);
+
+public:
+	Archetype(ComponentMask mask);
+	~Archetype();
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	/* A row at the end for entity, components left uninitialised */
+	void Add(unsigned int entity, unsigned int& chunk, unsigned int& row);
+	/* Fills the gap with the last entity, whose ID is returned so its location can be fixed up.
+	 * NONE if the removed entity was the last one */
+	unsigned int Remove(unsigned int chunk, unsigned int row);
+
+	inline bool Has(unsigned int type) const { return (m_Mask >> type) & 1; }
+	inline void* GetComponent(unsigned int chunk, unsigned int row, unsigned int type) const {
+		return m_Chunks[chunk].Data + m_Offsets[type] + row * GetComponentTypeInfo(type).Size;
+	}
+	template<typename T>
+	inline T* GetArray(unsigned int chunk) const {
+		return (T*)(m_Chunks[chunk].Data + m_Offsets[GetComponentType<T>()]);
+	}
+	inline const unsigned int* GetEntities(unsigned int chunk) const { return (const unsigned int*)m_Chunks[chunk].Data; }
+
+	inline ComponentMask GetMask() const { return m_Mask; }
+	inline const std::vector<unsigned int>& GetTypes() const { return m_Types; }
+	inline unsigned int GetChunkCount() const { return (unsigned int)m_Chunks.size(); }
+	inline unsigned int GetCount(unsigned int chunk) const { return m_Chunks[chunk].Count; }
+	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+};
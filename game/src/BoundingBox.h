@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+
+/* Axis aligned box. Empty() is inside out, so growing it by anything gives that thing's bounds */
+struct BoundingBox {
+	float Min[3];
+	float Max[3];
+
+	static inline BoundingBox Empty() {
+		return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+	}
+
+	inline void Grow(const BoundingBox& other) {
+		for (int axis = 0; axis < 3; axis++) {
+			Min[axis] = std::min(Min[axis], other.Min[axis]);
+			Max[axis] = std::max(Max[axis], other.Max[axis]);
+		}
+	}
+
+	inline void Grow(const float* point) {
+		for (int axis = 0; axis < 3; axis++) {
+			Min[axis] = std::min(Min[axis], point[axis]);
+			Max[axis] = std::max(Max[axis], point[axis]);
+		}
+	}
+
+	inline float GetCenter(int axis) const { return (Min[axis] + Max[axis]) * 0.5f; }
+
+	/* Half the surface area, which is all SAH costs need */
+	inline float GetHalfArea() const {
+		float x = Max[0] - Min[0], y = Max[1] - Min[1], z = Max[2] - Min[2];
+		return x < 0.0f ? 0.0f : x * y + y * z + z * x;
+	}
+
+	inline bool Overlaps(const BoundingBox& other) const {
+		return Min[0] <= other.Max[0] && Max[0] >= other.Min[0] &&
+			Min[1] <= other.Max[1] && Max[1] >= other.Min[1] &&
+			Min[2] <= other.Max[2] && Max[2] >= other.Min[2];
+	}
+
+	inline bool Contains(const BoundingBox& other) const {
+		return Min[0] <= other.Min[0] && Max[0] >= other.Max[0] &&
+			Min[1] <= other.Min[1] && Max[1] >= other.Max[1] &&
+			Min[2] <= other.Min[2] && Max[2] >= other.Max[2];
+	}
+
+	inline bool operator==(const BoundingBox& other) const {
+		return std::equal(Min, Min + 3, other.Min) && std::equal(Max, Max + 3, other.Max);
+	}
+};
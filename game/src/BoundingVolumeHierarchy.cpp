@@ -0,0 +1,370 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <cmath>
+
+/* Box against the planes still in mask. Clears the bits of planes it's wholly inside, false if it's outside one */
+static bool TestFrustum(const Frustum& frustum, const BoundingBox& box, unsigned int& mask) {
+	for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		if (!(mask & (1 << p))) {
+			continue;
+		}
+		const FrustumPlane& plane = frustum.Planes[p];
+		float distance = plane.Distance;
+		float radius = 0.0f;
+		for (int axis = 0; axis < 3; axis++) {
+			distance += plane.Normal[axis] * box.GetCenter(axis);
+			radius += std::fabs(plane.Normal[axis]) * (box.Max[axis] - box.Min[axis]) * 0.5f;
+		}
+		if (distance + radius < 0.0f) {
+			return false;
+		}
+		if (distance - radius >= 0.0f) {
+			mask &= ~(1 << p);
+		}
+	}
+	return true;
+}
+
+/* Distance along the ray to where it enters the box, or -1 if it misses within maxDistance */
+static float IntersectRay(const BoundingBox& box, const float* origin, const float* inverseDirection, float maxDistance) {
+	float enter = 0.0f;
+	float exit = maxDistance;
+	for (int axis = 0; axis < 3; axis++) {
+		float t0 = (box.Min[axis] - origin[axis]) * inverseDirection[axis];
+		float t1 = (box.Max[axis] - origin[axis]) * inverseDirection[axis];
+		enter = std::max(enter, std::min(t0, t1));
+		exit = std::min(exit, std::max(t0, t1));
+	}
+	return enter <= exit ? enter : -1.0f;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+	: m_NeedsBuild(false), m_BuiltArea(0.0f) {
+}
+
+unsigned int BoundingVolumeHierarchy::Add(const BoundingBox& bounds) {
+	m_ObjectBounds.push_back(bounds);
+	m_ObjectLeaf.push_back(0);
+	m_NeedsBuild = true;
+	return (unsigned int)m_ObjectBounds.size() - 1;
+}
+
+void BoundingVolumeHierarchy::SetBounds(unsigned int object, const BoundingBox& bounds) {
+	m_ObjectBounds[object] = bounds;
+	if (!m_NeedsBuild) {
+		m_DirtyLeaves.push_back(m_ObjectLeaf[object]);
+	}
+}
+
+void BoundingVolumeHierarchy::Clear() {
+	m_Nodes.clear();
+	m_Objects.clear();
+	m_ObjectBounds.clear();
+	m_ObjectLeaf.clear();
+	m_DirtyLeaves.clear();
+	m_NeedsBuild = false;
+	m_BuiltArea = 0.0f;
+}
+
+void BoundingVolumeHierarchy::Build() {
+	unsigned int count = (unsigned int)m_ObjectBounds.size();
+	m_Nodes.clear();
+	m_DirtyLeaves.clear();
+	m_NeedsBuild = false;
+	if (count == 0) {
+		m_BuiltArea = 0.0f;
+		return;
+	}
+
+	m_Objects.resize(count);
+	for (unsigned int i = 0; i < count; i++) {
+		m_Objects[i] = i;
+	}
+	/* A binary tree with n leaves has 2n - 1 nodes, and leaves hold at least one object */
+	m_Nodes.reserve(2 * count);
+	m_Nodes.push_back({ BoundingBox::Empty(), 0, count, -1 });
+	UpdateNodeBounds(0);
+	Subdivide(0);
+
+	for (unsigned int node = 0; node < m_Nodes.size(); node++) {
+		for (unsigned int i = 0; i < m_Nodes[node].Count; i++) {
+			m_ObjectLeaf[m_Objects[m_Nodes[node].LeftOrFirst + i]] = node;
+		}
+	}
+	m_BuiltArea = m_Nodes[0].Bounds.GetHalfArea();
+}
+
+void BoundingVolumeHierarchy::Subdivide(unsigned int root) {
+	/* Explicit stack rather than recursion: a degenerate scene (objects strung along a line, say) can make the
+	 * tree as deep as it is wide */
+	std::vector<unsigned int> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+	while (!stack.empty()) {
+		unsigned int node = stack.back();
+		stack.pop_back();
+
+		/* Copied, m_Nodes grows below */
+		Node current = m_Nodes[node];
+		if (current.Count <= 1) {
+			continue;
+		}
+
+		int axis;
+		float position;
+		float splitCost = FindSplit(current, axis, position);
+		float leafCost = current.Count * current.Bounds.GetHalfArea();
+		if (splitCost >= leafCost && current.Count <= MAX_LEAF_SIZE) {
+			continue;
+		}
+
+		unsigned int* first = &m_Objects[current.LeftOrFirst];
+		unsigned int* last = first + current.Count;
+		unsigned int* middle = last;
+		if (splitCost != FLT_MAX) {
+			middle = std::partition(first, last,
+				[this, axis, position](unsigned int object) { return m_ObjectBounds[object].GetCenter(axis) < position; });
+		}
+		if (middle == first || middle == last) {
+			/* Every centroid in the same place (or no split that separates them), but too many for one leaf */
+			middle = first + current.Count / 2;
+		}
+
+		unsigned int left = (unsigned int)m_Nodes.size();
+		unsigned int leftCount = (unsigned int)(middle - first);
+		m_Nodes.push_back({ BoundingBox::Empty(), current.LeftOrFirst, leftCount, (int)node });
+		m_Nodes.push_back({ BoundingBox::Empty(), current.LeftOrFirst + leftCount, current.Count - leftCount, (int)node });
+		m_Nodes[node].LeftOrFirst = left;
+		m_Nodes[node].Count = 0;
+
+		UpdateNodeBounds(left);
+		UpdateNodeBounds(left + 1);
+		stack.push_back(left + 1);
+		stack.push_back(left);
+	}
+}
+
+float BoundingVolumeHierarchy::FindSplit(const Node& node, int& axis, float& position) const {
+	BoundingBox centroids = BoundingBox::Empty();
+	for (unsigned int i = 0; i < node.Count; i++) {
+		const BoundingBox& bounds = m_ObjectBounds[m_Objects[node.LeftOrFirst + i]];
+		const float center[] = { bounds.GetCenter(0), bounds.GetCenter(1), bounds.GetCenter(2) };
+		centroids.Grow(center);
+	}
+
+	float bestCost = FLT_MAX;
+	for (int a = 0; a < 3; a++) {
+		float extent = centroids.Max[a] - centroids.Min[a];
+		if (extent <= 0.0f) {
+			continue;
+		}
+
+		BoundingBox binBounds[SAH_BINS];
+		unsigned int binCounts[SAH_BINS] = {};
+		for (BoundingBox& bin : binBounds) {
+			bin = BoundingBox::Empty();
+		}
+		float scale = SAH_BINS / extent;
+		for (unsigned int i = 0; i < node.Count; i++) {
+			const BoundingBox& bounds = m_ObjectBounds[m_Objects[node.LeftOrFirst + i]];
+			unsigned int bin = std::min(SAH_BINS - 1, (unsigned int)((bounds.GetCenter(a) - centroids.Min[a]) * scale));
+			binCounts[bin]++;
+			binBounds[bin].Grow(bounds);
+		}
+
+		/* Sweep from each end so every plane between bins is costed in one pass */
+		float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+		unsigned int leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+		BoundingBox leftBox = BoundingBox::Empty(), rightBox = BoundingBox::Empty();
+		unsigned int leftSum = 0, rightSum = 0;
+		for (unsigned int i = 0; i < SAH_BINS - 1; i++) {
+			leftSum += binCounts[i];
+			leftBox.Grow(binBounds[i]);
+			leftCount[i] = leftSum;
+			leftArea[i] = leftBox.GetHalfArea();
+
+			rightSum += binCounts[SAH_BINS - 1 - i];
+			rightBox.Grow(binBounds[SAH_BINS - 1 - i]);
+			rightCount[SAH_BINS - 2 - i] = rightSum;
+			rightArea[SAH_BINS - 2 - i] = rightBox.GetHalfArea();
+		}
+
+		for (unsigned int i = 0; i < SAH_BINS - 1; i++) {
+			float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+			if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost) {
+				bestCost = cost;
+				axis = a;
+				position = centroids.Min[a] + (i + 1) / scale;
+			}
+		}
+	}
+	return bestCost;
+}
+
+void BoundingVolumeHierarchy::UpdateNodeBounds(unsigned int node) {
+	Node& current = m_Nodes[node];
+	current.Bounds = BoundingBox::Empty();
+	if (current.Count > 0) {
+		for (unsigned int i = 0; i < current.Count; i++) {
+			current.Bounds.Grow(m_ObjectBounds[m_Objects[current.LeftOrFirst + i]]);
+		}
+	}
+	else {
+		current.Bounds.Grow(m_Nodes[current.LeftOrFirst].Bounds);
+		current.Bounds.Grow(m_Nodes[current.LeftOrFirst + 1].Bounds);
+	}
+}
+
+void BoundingVolumeHierarchy::Refit() {
+	for (unsigned int leaf : m_DirtyLeaves) {
+		int node = (int)leaf;
+		while (node != -1) {
+			BoundingBox previous = m_Nodes[node].Bounds;
+			UpdateNodeBounds(node);
+			/* Nothing above can change either */
+			if (m_Nodes[node].Bounds == previous) {
+				break;
+			}
+			node = m_Nodes[node].Parent;
+		}
+	}
+	m_DirtyLeaves.clear();
+}
+
+void BoundingVolumeHierarchy::Update() {
+	if (m_NeedsBuild) {
+		Build();
+		return;
+	}
+	Refit();
+	/* Refits keep the topology, so boxes follow their objects (growing or shrinking) but siblings that have
+	 * drifted apart stay paired. A root much bigger than at the build means that's happened a lot */
+	if (!m_Nodes.empty() && m_Nodes[0].Bounds.GetHalfArea() > 2.0f * m_BuiltArea) {
+		Build();
+	}
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& objects) const {
+	if (m_Nodes.empty()) {
+		return;
+	}
+
+	struct Entry {
+		unsigned int Node;
+		unsigned int Mask;   /* Planes the node still straddles */
+	};
+	std::vector<Entry> stack;
+	stack.reserve(64);
+	stack.push_back({ 0, (1 << FRUSTUM_PLANE_COUNT) - 1 });
+	while (!stack.empty()) {
+		Entry entry = stack.back();
+		stack.pop_back();
+		const Node& node = m_Nodes[entry.Node];
+		if (entry.Mask != 0 && !TestFrustum(frustum, node.Bounds, entry.Mask)) {
+			continue;
+		}
+
+		if (node.Count == 0) {
+			stack.push_back({ node.LeftOrFirst + 1, entry.Mask });
+			stack.push_back({ node.LeftOrFirst, entry.Mask });
+			continue;
+		}
+		for (unsigned int i = 0; i < node.Count; i++) {
+			unsigned int object = m_Objects[node.LeftOrFirst + i];
+			unsigned int mask = entry.Mask;
+			if (mask == 0 || TestFrustum(frustum, m_ObjectBounds[object], mask)) {
+				objects.push_back(object);
+			}
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::QueryBox(const BoundingBox& bounds, std::vector<unsigned int>& objects) const {
+	if (m_Nodes.empty()) {
+		return;
+	}
+
+	std::vector<unsigned int> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (!stack.empty()) {
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (!node.Bounds.Overlaps(bounds)) {
+			continue;
+		}
+
+		if (node.Count == 0) {
+			stack.push_back(node.LeftOrFirst + 1);
+			stack.push_back(node.LeftOrFirst);
+			continue;
+		}
+		for (unsigned int i = 0; i < node.Count; i++) {
+			unsigned int object = m_Objects[node.LeftOrFirst + i];
+			if (m_ObjectBounds[object].Overlaps(bounds)) {
+				objects.push_back(object);
+			}
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::Raycast(const float* origin, const float* direction, float maxDistance, RayHit& hit) const {
+	if (m_Nodes.empty()) {
+		return false;
+	}
+
+	/* Division by zero gives infinities, which the slab test handles */
+	const float inverseDirection[] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+	float nearest = maxDistance;
+	bool found = false;
+
+	struct Entry {
+		unsigned int Node;
+		float Distance;
+	};
+	std::vector<Entry> stack;
+	stack.reserve(64);
+	float rootDistance = IntersectRay(m_Nodes[0].Bounds, origin, inverseDirection, nearest);
+	if (rootDistance >= 0.0f) {
+		stack.push_back({ 0, rootDistance });
+	}
+	while (!stack.empty()) {
+		Entry entry = stack.back();
+		stack.pop_back();
+		/* Something nearer was found since this was pushed */
+		if (entry.Distance > nearest) {
+			continue;
+		}
+
+		const Node& node = m_Nodes[entry.Node];
+		if (node.Count == 0) {
+			/* Push the nearer child last so it's visited first, and its hits prune the other */
+			Entry children[2];
+			unsigned int count = 0;
+			for (unsigned int child = node.LeftOrFirst; child < node.LeftOrFirst + 2; child++) {
+				float distance = IntersectRay(m_Nodes[child].Bounds, origin, inverseDirection, nearest);
+				if (distance >= 0.0f) {
+					children[count++] = { child, distance };
+				}
+			}
+			if (count == 2 && children[0].Distance < children[1].Distance) {
+				std::swap(children[0], children[1]);
+			}
+			for (unsigned int i = 0; i < count; i++) {
+				stack.push_back(children[i]);
+			}
+			continue;
+		}
+
+		for (unsigned int i = 0; i < node.Count; i++) {
+			unsigned int object = m_Objects[node.LeftOrFirst + i];
+			float distance = IntersectRay(m_ObjectBounds[object], origin, inverseDirection, nearest);
+			if (distance >= 0.0f && (!found || distance < nearest)) {
+				nearest = distance;
+				hit = { object, distance };
+				found = true;
+			}
+		}
+	}
+	return found;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "BoundingBox.h"
+#include "Frustum.h"
+
+/* Closest object a ray's bounds test found */
+struct RayHit {
+	unsigned int Object;
+	float Distance;   /* Along the ray, in units of the direction's length */
+};
+
+/* Binary tree of boxes over the scene's objects, so queries only visit the subtrees that overlap them.
+ * - Build() makes a new tree with the surface area heuristic (binned): each split is the one that minimises
+ *   the expected cost of a random query, which is what keeps frustum and ray traversal short
+ * - Moving objects only need Refit(): changed leaves are re-bounded and the change walks up the parents,
+ *   stopping as soon as a node's box doesn't change. The topology stays put, so after enough movement the tree
+ *   loosens and is worth rebuilding (Update() does that when the root's area has doubled since the build)
+ * Objects are numbered in the order they're added, and those are the indices queries return.
+ */
+class BoundingVolumeHierarchy {
+private:
+	static const unsigned int MAX_LEAF_SIZE = 4;
+	static const unsigned int SAH_BINS = 12;
+
+	/* Children of an interior node are next to each other, at LeftOrFirst and LeftOrFirst + 1.
+	 * A leaf's objects are m_Objects[LeftOrFirst, LeftOrFirst + Count) */
+	struct Node {
+		BoundingBox Bounds;
+		unsigned int LeftOrFirst;
+		unsigned int Count;    /* 0 for interior nodes */
+		int Parent;            /* -1 for the root */
+	};
+
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_Objects;       /* Object indices, grouped by leaf */
+	std::vector<BoundingBox> m_ObjectBounds;   /* By object index */
+	std::vector<unsigned int> m_ObjectLeaf;    /* By object index */
+	std::vector<unsigned int> m_DirtyLeaves;
+	bool m_NeedsBuild;
+	float m_BuiltArea;
+
+	void Subdivide(unsigned int root);
+	/* Best split plane for a node, by SAH over SAH_BINS bins per axis. Returns its cost, FLT_MAX if there's none */
+	float FindSplit(const Node& node, int& axis, float& position) const;
+	void UpdateNodeBounds(unsigned int node);
+
+public:
+	BoundingVolumeHierarchy();
+
+	/* Returns the object's index. The tree isn't updated until Build() or Update() */
+	unsigned int Add(const BoundingBox& bounds);
+	/* Marks the object's leaf for the next Refit() */
+	void SetBounds(unsigned int object, const BoundingBox& bounds);
+	void Clear();
+
+	void Build();
+	void Refit();
+	/* Build() after Add() or when refits have loosened the tree, Refit() otherwise */
+	void Update();
+
+	/* Objects whose box is at least partly inside the frustum. Subtrees wholly inside skip the plane tests */
+	void QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& objects) const;
+	/* Objects whose box overlaps bounds */
+	void QueryBox(const BoundingBox& bounds, std::vector<unsigned int>& objects) const;
+	/* Nearest object whose box the ray enters within maxDistance. Boxes only, so test the hit's real geometry
+	 * if that matters (picking a mesh, say) */
+	bool Raycast(const float* origin, const float* direction, float maxDistance, RayHit& hit) const;
+
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_ObjectBounds.size(); }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	inline const BoundingBox& GetBounds(unsigned int object) const { return m_ObjectBounds[object]; }
+};
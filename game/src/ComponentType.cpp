@@ -0,0 +1,19 @@
+#include "ComponentType.h"
+
+#include <atomic>
+
+#include "Renderer.h"
+
+static ComponentTypeInfo s_ComponentTypes[MAX_COMPONENT_TYPES];
+static std::atomic<unsigned int> s_ComponentTypeCount(0);
+
+unsigned int RegisterComponentType(unsigned int size, unsigned int alignment) {
+	unsigned int type = s_ComponentTypeCount++;
+	ASSERT(type < MAX_COMPONENT_TYPES);
+	s_ComponentTypes[type] = { size, alignment };
+	return type;
+}
+
+const ComponentTypeInfo& GetComponentTypeInfo(unsigned int type) {
+	return s_ComponentTypes[type];
+}
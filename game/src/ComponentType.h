@@ -0,0 +1,32 @@
+#pragma once
+
+#include <type_traits>
+
+/* One bit per component type, so an archetype's component set is a single integer */
+typedef unsigned long long ComponentMask;
+
+static const unsigned int MAX_COMPONENT_TYPES = 64;
+
+struct ComponentTypeInfo {
+	unsigned int Size;
+	unsigned int Alignment;
+};
+
+/* Hands out the next type number. Safe to call from several threads */
+unsigned int RegisterComponentType(unsigned int size, unsigned int alignment);
+const ComponentTypeInfo& GetComponentTypeInfo(unsigned int type);
+
+/* Small dense number for T, assigned the first time it's asked for. Components are moved between chunks with
+ * memcpy and never constructed or destroyed in place, so they have to be plain data */
+template<typename T>
+inline unsigned int GetComponentType() {
+	static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+		"Components are moved with memcpy, they must be trivially copyable and destructible");
+	static const unsigned int type = RegisterComponentType((unsigned int)sizeof(T), (unsigned int)alignof(T));
+	return type;
+}
+
+template<typename... Ts>
+inline ComponentMask GetComponentMask() {
+	return (ComponentMask(0) | ... | (ComponentMask(1) << GetComponentType<Ts>()));
+}
@@ -0,0 +1,127 @@
+#include "DeletionQueue.h"
+
+#include "Renderer.h"
+
+DeletionQueue::State& DeletionQueue::GetState() {
+	static State state = {};
+	return state;
+}
+
+void DeletionQueue::Enqueue(GLObjectType type, unsigned int id) {
+	if (id == 0) {
+		return;
+	}
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.Mutex);
+	state.Pending.Objects[type].push_back(id);
+}
+
+void DeletionQueue::Enqueue(GLsync sync) {
+	if (!sync) {
+		return;
+	}
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.Mutex);
+	state.Pending.Syncs.push_back(sync);
+}
+
+/* Called with the lock held. Leaves the batch's vectors empty but with their capacity */
+void DeletionQueue::Delete(State& state, Batch& batch) {
+	if (batch.Fence) {
+		GLCall(glDeleteSync(batch.Fence));
+		batch.Fence = nullptr;
+	}
+
+	std::vector<unsigned int>& buffers = batch.Objects[BUFFER_OBJECT];
+	if (!buffers.empty()) {
+		GLCall(glDeleteBuffers((GLsizei)buffers.size(), buffers.data()));
+		state.Stats.Calls++;
+	}
+	std::vector<unsigned int>& vertexArrays = batch.Objects[VERTEX_ARRAY_OBJECT];
+	if (!vertexArrays.empty()) {
+		GLCall(glDeleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data()));
+		state.Stats.Calls++;
+	}
+	/* Programs and shader objects have no batched delete */
+	for (unsigned int program : batch.Objects[PROGRAM_OBJECT]) {
+		GLCall(glDeleteProgram(program));
+		state.Stats.Calls++;
+	}
+	for (unsigned int shader : batch.Objects[SHADER_OBJECT]) {
+		GLCall(glDeleteShader(shader));
+		state.Stats.Calls++;
+	}
+
+	/* No batched delete for these either */
+	for (GLsync sync : batch.Syncs) {
+		GLCall(glDeleteSync(sync));
+		state.Stats.Calls++;
+	}
+
+	for (std::vector<unsigned int>& objects : batch.Objects) {
+		state.Stats.Objects += objects.size();
+		objects.clear();
+	}
+	state.Stats.Objects += batch.Syncs.size();
+	batch.Syncs.clear();
+}
+
+bool DeletionQueue::IsEmpty(const Batch& batch) {
+	for (const std::vector<unsigned int>& objects : batch.Objects) {
+		if (!objects.empty()) {
+			return false;
+		}
+	}
+	return batch.Syncs.empty();
+}
+
+void DeletionQueue::Retire(State& state) {
+	if (IsEmpty(state.Pending)) {
+		return;
+	}
+	GLCall(state.Pending.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	state.Retiring.push_back(std::move(state.Pending));
+	state.Pending = {};
+}
+
+void DeletionQueue::EndFrame() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.Mutex);
+
+	Retire(state);
+	while (!state.Retiring.empty()) {
+		Batch& batch = state.Retiring.front();
+		/* A zero timeout just polls */
+		GLCall(GLenum result = glClientWaitSync(batch.Fence, 0, 0));
+		ASSERT(result != GL_WAIT_FAILED);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			break;
+		}
+		Delete(state, batch);
+		state.Retiring.pop_front();
+	}
+}
+
+void DeletionQueue::Flush() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.Mutex);
+
+	/* Same rule as EndFrame, nothing goes before a fence after its last use has signalled. Here we wait for it */
+	Retire(state);
+	for (Batch& batch : state.Retiring) {
+		GLCall(GLenum result = glClientWaitSync(batch.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED));
+		ASSERT(result != GL_WAIT_FAILED);
+		Delete(state, batch);
+	}
+	state.Retiring.clear();
+}
+
+const DeletionStats& DeletionQueue::GetStats() {
+	return GetState().Stats;
+}
+
+void DeletionQueue::ResetStats() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.Mutex);
+	state.Stats = { 0, 0 };
+}
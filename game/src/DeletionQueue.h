@@ -0,0 +1,70 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <GL/glew.h>
+
+/* What kind of GL object a queued name is, so the queue knows which glDelete* to batch it into */
+enum GLObjectType : unsigned int {
+	BUFFER_OBJECT = 0,
+	VERTEX_ARRAY_OBJECT,
+	PROGRAM_OBJECT,
+	SHADER_OBJECT,
+	GL_OBJECT_TYPE_COUNT
+};
+
+/* GL objects deleted so far, and how many glDelete* calls that took */
+struct DeletionStats {
+	unsigned long long Objects;
+	unsigned long long Calls;
+};
+
+/* The GL wrappers' destructors hand their objects in here rather than deleting them on the spot, so destroying
+ * one mid-frame (or on a thread without the context) costs a push_back and no GL call.
+ * EndFrame() puts a fence after everything queued during the frame, and once that fence has signalled the whole
+ * batch goes in one glDeleteBuffers/glDeleteVertexArrays per type. Nothing is deleted while the GPU could still
+ * be using it, and unloading a thousand meshes is a handful of calls instead of thousands.
+ * Flush() fences whatever is still pending and deletes everything once the GPU is done. Call it before the
+ * context goes; anything queued after that is never deleted, which is harmless once the context is gone.
+ */
+class DeletionQueue {
+private:
+	struct Batch {
+		GLsync Fence;
+		std::vector<unsigned int> Objects[GL_OBJECT_TYPE_COUNT];
+		/* Other owners' fences, not the batch's own */
+		std::vector<GLsync> Syncs;
+	};
+
+	struct State {
+		std::mutex Mutex;
+		/* Queued since the last EndFrame */
+		Batch Pending;
+		/* Fenced, oldest first. Fences signal in order, so only the front needs checking */
+		std::deque<Batch> Retiring;
+		DeletionStats Stats;
+	};
+
+	/* Function static so wrappers destroyed during static destruction still have a queue */
+	static State& GetState();
+	static void Delete(State& state, Batch& batch);
+	static bool IsEmpty(const Batch& batch);
+	/* Puts a fence after the pending batch and moves it on to Retiring */
+	static void Retire(State& state);
+
+public:
+	/* Safe from any thread. Name 0 is ignored */
+	static void Enqueue(GLObjectType type, unsigned int id);
+	/* Sync objects aren't named by an unsigned int. nullptr is ignored */
+	static void Enqueue(GLsync sync);
+
+	/* Once per frame, after the frame's commands are issued. Never waits on the GPU */
+	static void EndFrame();
+	/* Deletes everything queued, waiting for any fences that haven't signalled */
+	static void Flush();
+
+	static const DeletionStats& GetStats();
+	static void ResetStats();
+};
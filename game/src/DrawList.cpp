@@ -0,0 +1,179 @@
+#include "DrawList.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+
+/* Bounds are stored one CullBounds per entity, FrustumCuller wants an array per member. Chunks are transposed
+ * this many at a time into arrays on the stack, so the SIMD kernel runs over them without allocating */
+static const unsigned int CULL_BLOCK = 64;
+
+static void CullChunk(const Frustum& frustum, const Bounds* bounds, unsigned int count, unsigned char* visible) {
+	alignas(32) float members[7][CULL_BLOCK];
+	CullArrays arrays = { members[0], members[1], members[2], members[3], members[4], members[5], members[6] };
+	for (unsigned int first = 0; first < count; first += CULL_BLOCK) {
+		unsigned int blockCount = std::min(CULL_BLOCK, count - first);
+		for (unsigned int i = 0; i < blockCount; i++) {
+			const CullBounds& world = bounds[first + i].World;
+			members[0][i] = world.Center[0];
+			members[1][i] = world.Center[1];
+			members[2][i] = world.Center[2];
+			members[3][i] = world.Extents[0];
+			members[4][i] = world.Extents[1];
+			members[5][i] = world.Extents[2];
+			members[6][i] = world.Radius;
+		}
+		/* The kernel reads whole groups, keep the tail of a short block defined */
+		unsigned int padded = std::min(CULL_BLOCK, (blockCount + FrustumCuller::LANES - 1) / FrustumCuller::LANES * FrustumCuller::LANES);
+		for (float* member : members) {
+			std::fill(member + blockCount, member + padded, 0.0f);
+		}
+		FrustumCuller::Cull(frustum, arrays, blockCount, visible + first);
+	}
+}
+
+/* In m_TreeObjects, for entities the tree doesn't have */
+static const unsigned int NO_OBJECT = 0xffffffff;
+
+static BoundingBox ToBox(const CullBounds& bounds) {
+	BoundingBox box;
+	for (int axis = 0; axis < 3; axis++) {
+		box.Min[axis] = bounds.Center[axis] - bounds.Extents[axis];
+		box.Max[axis] = bounds.Center[axis] + bounds.Extents[axis];
+	}
+	return box;
+}
+
+DrawList::DrawList(FrameAllocator& allocator)
+	: m_Allocator(allocator), m_Draws(nullptr), m_DrawCount(0), m_Stats({ 0, 0, 0 }), m_TreeWorld(nullptr),
+	m_TreeVersion(0) {
+}
+
+void DrawList::Extract(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum) {
+	unsigned int count = world.Count<Transform, MeshRef, MaterialRef, Bounds>();
+	if (count >= TREE_THRESHOLD) {
+		ExtractTree(world, resources, frustum);
+	}
+	else {
+		/* Not kept up to date down here, so it would need a rebuild anyway */
+		ClearTree();
+		ExtractChunks(world, resources, frustum, count);
+	}
+	/* Not stable_sort, which allocates a buffer. The entity makes every key unique instead */
+	std::sort(m_Draws, m_Draws + m_DrawCount, [](const Draw& a, const Draw& b) {
+		return a.SortKey != b.SortKey ? a.SortKey < b.SortKey : a.Entity < b.Entity;
+	});
+
+	m_Stats.Tested += count;
+	m_Stats.Visible += m_DrawCount;
+	m_Stats.Culled += count - m_DrawCount;
+}
+
+void DrawList::SetBounds(EntityWorld& world, unsigned int entity, const CullBounds& bounds) {
+	world.Get<Bounds>(entity).World = bounds;
+	if (m_TreeWorld == &world && entity < m_TreeObjects.size() && m_TreeObjects[entity] != NO_OBJECT) {
+		m_Tree.SetBounds(m_TreeObjects[entity], ToBox(bounds));
+	}
+}
+
+void DrawList::ExtractChunks(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum,
+	unsigned int count) {
+	Draw* extracted = m_Allocator.Allocate<Draw>(count);
+	unsigned char* visible = m_Allocator.Allocate<unsigned char>(count);
+
+	/* Jobs only read the registry, nothing creates or destroys resources during Extract */
+	world.ParallelForEachChunk<Transform, MeshRef, MaterialRef, Bounds>([extracted, visible, &resources, &frustum](
+		unsigned int first, unsigned int chunkCount, const unsigned int* entities, Transform* transforms, MeshRef* meshes,
+		MaterialRef* materials, Bounds* bounds) {
+		CullChunk(frustum, bounds, chunkCount, visible + first);
+		for (unsigned int i = 0; i < chunkCount; i++) {
+			const Material* material = visible[first + i] ? resources.Get(materials[i].Instance) : nullptr;
+			visible[first + i] = material != nullptr;
+			if (material) {
+				Draw& draw = extracted[first + i];
+				draw.SortKey = material->GetSortKey();
+				draw.Entity = entities[i];
+				draw.Vertices = meshes[i].Vertices;
+				draw.Indices = meshes[i].Indices;
+				draw.Instance = materials[i].Instance;
+				draw.Object.Model = transforms[i].World.ToStd140();
+			}
+		}
+	});
+
+	/* In place, visible draws only move towards the front */
+	m_Draws = extracted;
+	m_DrawCount = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		if (visible[i]) {
+			m_Draws[m_DrawCount++] = extracted[i];
+		}
+	}
+}
+
+void DrawList::ExtractTree(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum) {
+	if (m_TreeWorld != &world || m_TreeVersion != world.GetStructureVersion()) {
+		BuildTree(world);
+	}
+	m_Tree.Update();
+
+	m_TreeVisible.clear();
+	m_Tree.QueryFrustum(frustum, m_TreeVisible);
+	m_Draws = m_Allocator.Allocate<Draw>((unsigned int)m_TreeVisible.size());
+	m_DrawCount = 0;
+	for (unsigned int object : m_TreeVisible) {
+		unsigned int entity = m_TreeEntities[object];
+		ResourceHandle<Material> instance = world.Get<MaterialRef>(entity).Instance;
+		const Material* material = resources.Get(instance);
+		if (!material) {
+			continue;
+		}
+		const MeshRef& mesh = world.Get<MeshRef>(entity);
+		Draw& draw = m_Draws[m_DrawCount++];
+		draw.SortKey = material->GetSortKey();
+		draw.Entity = entity;
+		draw.Vertices = mesh.Vertices;
+		draw.Indices = mesh.Indices;
+		draw.Instance = instance;
+		draw.Object.Model = world.Get<Transform>(entity).World.ToStd140();
+	}
+}
+
+void DrawList::BuildTree(const EntityWorld& world) {
+	ClearTree();
+	world.ForEachChunk<Transform, MeshRef, MaterialRef, Bounds>([this](unsigned int, unsigned int count,
+		const unsigned int* entities, Transform*, MeshRef*, MaterialRef*, Bounds* bounds) {
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int entity = entities[i];
+			if (entity >= m_TreeObjects.size()) {
+				m_TreeObjects.resize(entity + 1, NO_OBJECT);
+			}
+			m_TreeObjects[entity] = m_Tree.Add(ToBox(bounds[i].World));
+			m_TreeEntities.push_back(entity);
+		}
+	});
+	m_TreeWorld = &world;
+	m_TreeVersion = world.GetStructureVersion();
+}
+
+void DrawList::ClearTree() {
+	if (!m_TreeWorld) {
+		return;
+	}
+	m_Tree.Clear();
+	m_TreeEntities.clear();
+	m_TreeObjects.clear();
+	m_TreeWorld = nullptr;
+}
+
+void DrawList::Submit(Renderer& renderer, ResourceRegistry& resources) const {
+	for (unsigned int i = 0; i < m_DrawCount; i++) {
+		const Draw& draw = m_Draws[i];
+		const VertexArray* vertices = resources.Get(draw.Vertices);
+		const IndexBuffer* indices = resources.Get(draw.Indices);
+		Material* material = resources.Get(draw.Instance);
+		if (vertices && indices && material) {
+			renderer.Draw(*vertices, *indices, *material, resources, draw.Object);
+		}
+	}
+}
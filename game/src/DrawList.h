@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include "BoundingVolumeHierarchy.h"
+#include "EntityWorld.h"
+#include "FrameAllocator.h"
+#include "Frustum.h"
+#include "FrustumCuller.h"
+#include "RenderComponents.h"
+#include "ResourceRegistry.h"
+#include "UniformBlocks.h"
+
+class Renderer;
+
+/* The render extraction step: turns every entity with Transform, MeshRef, MaterialRef and Bounds into a draw.
+ * Extract() walks the entities chunk by chunk in parallel, reading the four component arrays straight through,
+ * drops anything outside the frustum and sorts what's left by material so Submit() changes state as little as
+ * it can. The draws are plain data, so nothing in the world is touched while submitting.
+ * Everything Extract() builds comes out of the FrameAllocator, so in steady state a frame's draw list costs no
+ * heap allocation. The draws stay valid until the allocator comes back round to this frame's arenas.
+ * Meshes and materials stay as handles until Submit() looks them up, so a draw is plain data and nothing dangles.
+ * From TREE_THRESHOLD renderables up, testing every one costs more than walking a BoundingVolumeHierarchy over
+ * them, so Extract() queries that instead. The tree is rebuilt when the world's structure version changes (which
+ * does allocate) and refitted for bounds changed through SetBounds(), which is why moving a renderable should go
+ * through it.
+ */
+class DrawList {
+public:
+	struct Draw {
+		unsigned long long SortKey;   /* Material::GetSortKey */
+		unsigned int Entity;          /* Breaks ties, so equal keys keep the same order from frame to frame */
+		ResourceHandle<VertexArray> Vertices;
+		ResourceHandle<IndexBuffer> Indices;
+		ResourceHandle<Material> Instance;
+		ObjectConstants Object;
+	};
+
+private:
+	static const unsigned int TREE_THRESHOLD = 4096;
+
+	FrameAllocator& m_Allocator;
+	/* The visible draws, sorted. Below TREE_THRESHOLD it starts with a slot per renderable, compacted in place */
+	Draw* m_Draws;
+	unsigned int m_DrawCount;
+	CullStats m_Stats;
+
+	BoundingVolumeHierarchy m_Tree;
+	std::vector<unsigned int> m_TreeEntities;   /* By tree object */
+	std::vector<unsigned int> m_TreeObjects;    /* By entity, NO_OBJECT if it isn't in the tree */
+	std::vector<unsigned int> m_TreeVisible;    /* Query results, kept to reuse their storage */
+	/* The world and structure version the tree was built from, nullptr if there's no tree */
+	const EntityWorld* m_TreeWorld;
+	unsigned long long m_TreeVersion;
+
+	void ExtractChunks(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum, unsigned int count);
+	void ExtractTree(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum);
+	void BuildTree(const EntityWorld& world);
+	void ClearTree();
+
+public:
+	DrawList(FrameAllocator& allocator);
+
+	/* resources is only read, to sort by material. Renderables whose material has been destroyed are dropped */
+	void Extract(const EntityWorld& world, const ResourceRegistry& resources, const Frustum& frustum);
+	/* Writes the entity's Bounds and keeps the tree in step. Writing the component directly works below
+	 * TREE_THRESHOLD, but above it the tree would keep culling against the old bounds */
+	void SetBounds(EntityWorld& world, unsigned int entity, const CullBounds& bounds);
+	/* Draws whose mesh, material or shader has been destroyed since Extract are skipped */
+	void Submit(Renderer& renderer, ResourceRegistry& resources) const;
+
+	inline const Draw* GetDraws() const { return m_Draws; }
+	inline unsigned int GetDrawCount() const { return m_DrawCount; }
+	/* Same counts as FrustumCuller's, over every Extract since the last ResetStats. Renderables dropped for a
+	 * destroyed material count as culled */
+	inline const CullStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = { 0, 0, 0 }; }
+};
@@ -0,0 +1,21 @@
+#include "EmbeddedShader.h"
+
+/* Generated before every build by shadertool embed. Only included here, so a shader edit rebuilds one file */
+#include "generated/EmbeddedShaders.h"
+
+EmbeddedShaderTable GetEmbeddedShaders() {
+	return { s_EmbeddedShaders, s_EmbeddedShaderCount };
+}
+
+const EmbeddedShader* FindEmbeddedShader(std::string_view path) {
+	for (const EmbeddedShader& shader : GetEmbeddedShaders()) {
+		if (shader.Path == path) {
+			return &shader;
+		}
+	}
+	return nullptr;
+}
+
+ShaderUniformLocationView GetEmbeddedUniformLocations(const EmbeddedShader& shader) {
+	return ShaderUniformLocationView(shader.UniformLocations, shader.UniformLocationCount);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "Shader.h"
+
+/* A built in shader, compiled into the executable by shadertool (see the pre-build step).
+ * Stages are split and includes resolved at build time, so using one needs no file I/O, doesn't depend on the
+ * working directory and builds no strings. Path is the name it would be loaded by, eg. "res/shaders/basic.shader".
+ */
+struct EmbeddedShader {
+	std::string_view Path;
+	/* Indexed by ShaderStage, empty for stages the shader doesn't have */
+	std::string_view Sources[SHADER_STAGE_COUNT];
+	/* layout(location = N) uniforms, found when the shader was embedded */
+	const EmbeddedUniformLocation* UniformLocations;
+	size_t UniformLocationCount;
+};
+
+struct EmbeddedShaderTable {
+	const EmbeddedShader* Data;
+	size_t Count;
+
+	inline const EmbeddedShader* begin() const { return Data; }
+	inline const EmbeddedShader* end() const { return Data + Count; }
+};
+
+EmbeddedShaderTable GetEmbeddedShaders();
+/* nullptr if path isn't built in */
+const EmbeddedShader* FindEmbeddedShader(std::string_view path);
+/* In the form Shader takes them, viewing the table in place */
+ShaderUniformLocationView GetEmbeddedUniformLocations(const EmbeddedShader& shader);
@@ -0,0 +1,73 @@
+#include "EntityWorld.h"
+
+#include <cstring>
+
+#include "Renderer.h"
+
+EntityWorld::EntityWorld()
+	: m_EntityCount(0), m_StructureVersion(0), m_Jobs(nullptr) {
+}
+
+Archetype& EntityWorld::GetArchetype(ComponentMask mask) {
+	auto found = m_ArchetypesByMask.find(mask);
+	if (found != m_ArchetypesByMask.end()) {
+		return *found->second;
+	}
+	m_Archetypes.push_back(std::make_unique<Archetype>(mask));
+	m_ArchetypesByMask[mask] = m_Archetypes.back().get();
+	return *m_Archetypes.back();
+}
+
+unsigned int EntityWorld::Place(ComponentMask mask) {
+	unsigned int entity = (unsigned int)m_Records.size();
+	EntityRecord record;
+	record.Storage = &GetArchetype(mask);
+	record.Storage->Add(entity, record.Chunk, record.Row);
+	m_Records.push_back(record);
+	m_EntityCount++;
+	m_StructureVersion++;
+	return entity;
+}
+
+void EntityWorld::Destroy(unsigned int entity) {
+	ASSERT(IsAlive(entity));
+	EntityRecord& record = m_Records[entity];
+	unsigned int moved = record.Storage->Remove(record.Chunk, record.Row);
+	if (moved != Archetype::NONE) {
+		m_Records[moved].Chunk = record.Chunk;
+		m_Records[moved].Row = record.Row;
+	}
+	record.Storage = nullptr;
+	m_EntityCount--;
+	m_StructureVersion++;
+}
+
+void EntityWorld::Move(unsigned int entity, ComponentMask mask) {
+	EntityRecord& record = m_Records[entity];
+	Archetype& from = *record.Storage;
+	Archetype& to = GetArchetype(mask);
+
+	unsigned int chunk, row;
+	to.Add(entity, chunk, row);
+	for (unsigned int type : to.GetTypes()) {
+		if (from.Has(type)) {
+			memcpy(to.GetComponent(chunk, row, type), from.GetComponent(record.Chunk, record.Row, type), GetComponentTypeInfo(type).Size);
+		}
+	}
+
+	unsigned int moved = from.Remove(record.Chunk, record.Row);
+	if (moved != Archetype::NONE) {
+		m_Records[moved].Chunk = record.Chunk;
+		m_Records[moved].Row = record.Row;
+	}
+	record.Storage = &to;
+	record.Chunk = chunk;
+	record.Row = row;
+	m_StructureVersion++;
+}
+
+void* EntityWorld::GetComponent(unsigned int entity, unsigned int type) const {
+	const EntityRecord& record = m_Records[entity];
+	ASSERT(record.Storage && record.Storage->Has(type));
+	return record.Storage->GetComponent(record.Chunk, record.Row, type);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Archetype.h"
+#include "JobSystem.h"
+
+/* Entities and their components, stored by archetype (see Archetype).
+ * Entities are plain numbers. Adding or removing a component moves the entity's data to the archetype for its new
+ * component set, so do that between queries, not during one. Queries visit every chunk whose archetype has all the
+ * components asked for and hand the callback the chunk's arrays, one pointer per component:
+ *     world.ForEachChunk<Transform, Bounds>([](unsigned int first, unsigned int count, const unsigned int* entities,
+ *         Transform* transforms, Bounds* bounds) { ... });
+ * first is where the chunk starts if the query's entities were numbered 0, 1, 2... in visiting order, which lets
+ * parallel callbacks write into one shared output without overlapping.
+ * Destroyed entity numbers aren't reused.
+ */
+class EntityWorld {
+public:
+	static const unsigned int NONE = 0xffffffff;
+
+private:
+	/* Fewer entities than this aren't worth splitting into jobs */
+	static const unsigned int PARALLEL_THRESHOLD = 4096;
+
+	struct EntityRecord {
+		Archetype* Storage;   /* nullptr once destroyed */
+		unsigned int Chunk;
+		unsigned int Row;
+	};
+
+	std::vector<EntityRecord> m_Records;
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<ComponentMask, Archetype*> m_ArchetypesByMask;
+	unsigned int m_EntityCount;
+	/* Bumped whenever an entity is created, destroyed or changes archetype */
+	unsigned long long m_StructureVersion;
+	JobSystem* m_Jobs;
+
+	Archetype& GetArchetype(ComponentMask mask);
+	unsigned int Place(ComponentMask mask);
+	/* Moves the entity to the archetype for mask, keeping the components both have */
+	void Move(unsigned int entity, ComponentMask mask);
+	void* GetComponent(unsigned int entity, unsigned int type) const;
+
+	template<typename T>
+	inline void Write(unsigned int entity, const T& component) {
+		*(T*)GetComponent(entity, GetComponentType<T>()) = component;
+	}
+
+public:
+	EntityWorld();
+
+	template<typename... Ts>
+	unsigned int Create(const Ts&... components) {
+		unsigned int entity = Place(GetComponentMask<Ts...>());
+		(Write(entity, components), ...);
+		return entity;
+	}
+	void Destroy(unsigned int entity);
+	inline bool IsAlive(unsigned int entity) const { return entity < m_Records.size() && m_Records[entity].Storage; }
+
+	/* Replaces the component if the entity already has one */
+	template<typename T>
+	void Add(unsigned int entity, const T& component) {
+		if (!Has<T>(entity)) {
+			Move(entity, m_Records[entity].Storage->GetMask() | GetComponentMask<T>());
+		}
+		Write(entity, component);
+	}
+	template<typename T>
+	void Remove(unsigned int entity) {
+		if (Has<T>(entity)) {
+			Move(entity, m_Records[entity].Storage->GetMask() & ~GetComponentMask<T>());
+		}
+	}
+	template<typename T>
+	inline bool Has(unsigned int entity) const { return m_Records[entity].Storage->Has(GetComponentType<T>()); }
+	template<typename T>
+	inline T& Get(unsigned int entity) const {
+		return *(T*)GetComponent(entity, GetComponentType<T>());
+	}
+
+	template<typename... Ts, typename F>
+	void ForEachChunk(F f) const {
+		ComponentMask mask = GetComponentMask<Ts...>();
+		unsigned int first = 0;
+		for (const std::unique_ptr<Archetype>& archetype : m_Archetypes) {
+			if ((archetype->GetMask() & mask) != mask) {
+				continue;
+			}
+			for (unsigned int chunk = 0; chunk < archetype->GetChunkCount(); chunk++) {
+				unsigned int count = archetype->GetCount(chunk);
+				if (count > 0) {
+					f(first, count, archetype->GetEntities(chunk), archetype->GetArray<Ts>(chunk)...);
+					first += count;
+				}
+			}
+		}
+	}
+
+	/* ForEachChunk with a job per chunk (see SetJobSystem). Callbacks run concurrently, so they should only write
+	 * to their own chunk's components or their own part of an output.
+	 * Only the last chunk of an archetype is partly full, so a chunk's first index is worked out rather than
+	 * collected beforehand, and the query doesn't allocate */
+	template<typename... Ts, typename F>
+	void ParallelForEachChunk(F f) const {
+		if (!m_Jobs || Count<Ts...>() < PARALLEL_THRESHOLD) {
+			ForEachChunk<Ts...>(f);
+			return;
+		}
+		ComponentMask mask = GetComponentMask<Ts...>();
+		unsigned int base = 0;
+		for (const std::unique_ptr<Archetype>& archetype : m_Archetypes) {
+			if ((archetype->GetMask() & mask) != mask) {
+				continue;
+			}
+			const Archetype& storage = *archetype;
+			m_Jobs->ParallelFor(0, storage.GetChunkCount(), 1, [&storage, base, &f](unsigned int begin, unsigned int end) {
+				for (unsigned int chunk = begin; chunk < end; chunk++) {
+					unsigned int count = storage.GetCount(chunk);
+					if (count > 0) {
+						f(base + chunk * storage.GetCapacity(), count, storage.GetEntities(chunk), storage.GetArray<Ts>(chunk)...);
+					}
+				}
+			});
+			base += storage.GetCount();
+		}
+	}
+
+	/* Per entity rather than per chunk: f(entity, components...) */
+	template<typename... Ts, typename F>
+	void ForEach(F f) const {
+		ForEachChunk<Ts...>([&f](unsigned int, unsigned int count, const unsigned int* entities, Ts*... arrays) {
+			for (unsigned int i = 0; i < count; i++) {
+				f(entities[i], arrays[i]...);
+			}
+		});
+	}
+
+	/* Entities a query for Ts would visit */
+	template<typename... Ts>
+	unsigned int Count() const {
+		ComponentMask mask = GetComponentMask<Ts...>();
+		unsigned int count = 0;
+		for (const std::unique_ptr<Archetype>& archetype : m_Archetypes) {
+			if ((archetype->GetMask() & mask) == mask) {
+				count += archetype->GetCount();
+			}
+		}
+		return count;
+	}
+
+	inline unsigned int GetEntityCount() const { return m_EntityCount; }
+	inline unsigned int GetArchetypeCount() const { return (unsigned int)m_Archetypes.size(); }
+	/* Changes whenever the set of entities a query could visit might have, so anything built from a query (DrawList's
+	 * tree, say) can tell when to rebuild. Writing to components doesn't change it */
+	inline unsigned long long GetStructureVersion() const { return m_StructureVersion; }
+	/* Without one (the default), parallel queries stay on the calling thread */
+	inline void SetJobSystem(JobSystem* jobs) { m_Jobs = jobs; }
+};
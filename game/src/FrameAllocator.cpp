@@ -0,0 +1,62 @@
+#include "FrameAllocator.h"
+
+#include "Renderer.h"
+
+/* Handed out to each allocator in turn, 0 is never used */
+static std::atomic<unsigned long long> s_NextInstance(1);
+
+/* The last allocator this thread used and its index there, so the lookup is usually two compares.
+ * Keyed on the instance rather than the address, a new allocator built where an old one was must not match */
+static thread_local unsigned long long s_CachedInstance = 0;
+static thread_local unsigned int s_CachedThread = 0;
+
+FrameAllocator::FrameAllocator(size_t blockSize)
+	: m_Instance(s_NextInstance.fetch_add(1)), m_ThreadCount(0), m_Frame(0), m_BlockSize(blockSize) {
+}
+
+unsigned int FrameAllocator::GetThreadIndex() {
+	if (s_CachedInstance == m_Instance) {
+		return s_CachedThread;
+	}
+
+	std::lock_guard<std::mutex> lock(m_RegisterMutex);
+	auto found = m_ThreadIndices.find(std::this_thread::get_id());
+	unsigned int index;
+	if (found != m_ThreadIndices.end()) {
+		index = found->second;
+	}
+	else {
+		index = m_ThreadCount.load();
+		ASSERT(index < MAX_THREADS);
+		for (unsigned int frame = 0; frame < FRAMES_IN_FLIGHT; frame++) {
+			m_Arenas[index][frame] = std::make_unique<LinearArena>(m_BlockSize);
+		}
+		m_ThreadIndices[std::this_thread::get_id()] = index;
+		/* Published after the arenas exist, BeginFrame and GetUsed only look at threads below the count */
+		m_ThreadCount.store(index + 1);
+	}
+	s_CachedInstance = m_Instance;
+	s_CachedThread = index;
+	return index;
+}
+
+void FrameAllocator::BeginFrame() {
+	m_Frame = (m_Frame + 1) % FRAMES_IN_FLIGHT;
+	unsigned int threads = m_ThreadCount.load();
+	for (unsigned int thread = 0; thread < threads; thread++) {
+		m_Arenas[thread][m_Frame]->Reset();
+	}
+}
+
+LinearArena& FrameAllocator::GetArena() {
+	return *m_Arenas[GetThreadIndex()][m_Frame];
+}
+
+size_t FrameAllocator::GetUsed() const {
+	size_t used = 0;
+	unsigned int threads = m_ThreadCount.load();
+	for (unsigned int thread = 0; thread < threads; thread++) {
+		used += m_Arenas[thread][m_Frame]->GetUsed();
+	}
+	return used;
+}
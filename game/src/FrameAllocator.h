@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "LinearArena.h"
+
+/* Scratch memory that lasts for a frame: render queue entries, culling output, anything rebuilt every frame.
+ * Each thread gets its own LinearArena per frame, so jobs allocate without locking or contending. There are
+ * FRAMES_IN_FLIGHT sets of them used in turn, so what one frame allocated is still valid while the next one or
+ * two are being built (the renderer consuming last frame's draws, say). BeginFrame() moves on to the next set
+ * and resets it. Once the arenas have grown to a frame's peak, allocating never touches the heap.
+ */
+class FrameAllocator {
+public:
+	/* Same depth as the renderer's UniformRingBuffer */
+	static const unsigned int FRAMES_IN_FLIGHT = 3;
+	static const unsigned int MAX_THREADS = 64;
+
+private:
+	/* Unique per allocator, for the per-thread index cache */
+	const unsigned long long m_Instance;
+	/* Fixed size, so threads can index it while another registers. By thread, then frame */
+	std::unique_ptr<LinearArena> m_Arenas[MAX_THREADS][FRAMES_IN_FLIGHT];
+	std::atomic<unsigned int> m_ThreadCount;
+	std::mutex m_RegisterMutex;
+	std::unordered_map<std::thread::id, unsigned int> m_ThreadIndices;
+	unsigned int m_Frame;
+	size_t m_BlockSize;
+
+	unsigned int GetThreadIndex();
+
+public:
+	FrameAllocator(size_t blockSize = LinearArena::DEFAULT_BLOCK_SIZE);
+	FrameAllocator(const FrameAllocator&) = delete;
+	FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+	/* Call once per frame, while nothing is allocating. What was allocated FRAMES_IN_FLIGHT frames ago is gone */
+	void BeginFrame();
+
+	/* The calling thread's arena for this frame */
+	LinearArena& GetArena();
+	template<typename T>
+	inline T* Allocate(size_t count = 1) { return GetArena().Allocate<T>(count); }
+
+	/* Across all threads, this frame so far */
+	size_t GetUsed() const;
+};
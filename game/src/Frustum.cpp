@@ -0,0 +1,26 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+Frustum Frustum::FromViewProjection(const float* matrix) {
+	/* Row i of a column major matrix is m[i], m[4 + i], m[8 + i], m[12 + i]. Clip space keeps points with
+	 * -w <= x, y, z <= w, so each plane is row 3 plus or minus one of the other rows */
+	auto row = [matrix](int i, int column) { return matrix[column * 4 + i]; };
+
+	Frustum frustum;
+	for (unsigned int plane = 0; plane < FRUSTUM_PLANE_COUNT; plane++) {
+		int axis = plane / 2;
+		float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+		float coefficients[4];
+		for (int column = 0; column < 4; column++) {
+			coefficients[column] = row(3, column) + sign * row(axis, column);
+		}
+
+		float length = std::sqrt(coefficients[0] * coefficients[0] + coefficients[1] * coefficients[1] +
+			coefficients[2] * coefficients[2]);
+		float scale = length > 0.0f ? 1.0f / length : 0.0f;
+		frustum.Planes[plane] = { { coefficients[0] * scale, coefficients[1] * scale, coefficients[2] * scale },
+			coefficients[3] * scale };
+	}
+	return frustum;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/* A plane as n.p + Distance = 0, Normal pointing into the frustum */
+struct FrustumPlane {
+	float Normal[3];
+	float Distance;
+};
+
+enum FrustumPlaneIndex : unsigned int {
+	LEFT_PLANE = 0, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, FRUSTUM_PLANE_COUNT
+};
+
+struct Frustum {
+	FrustumPlane Planes[FRUSTUM_PLANE_COUNT];
+
+	/* Extracts the planes from a column major view-projection matrix (Gribb & Hartmann), so they're in world
+	 * space. With a model-view-projection they'd be in that model's space instead. Normals are unit length, so
+	 * a plane's signed distance can be compared against a radius. */
+	static Frustum FromViewProjection(const float* matrix);
+};
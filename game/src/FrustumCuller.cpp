@@ -0,0 +1,165 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h"
+
+CullBounds CullBounds::FromBox(const float* min, const float* max) {
+	CullBounds bounds;
+	for (int axis = 0; axis < 3; axis++) {
+		bounds.Center[axis] = (min[axis] + max[axis]) * 0.5f;
+		bounds.Extents[axis] = (max[axis] - min[axis]) * 0.5f;
+	}
+	bounds.Radius = std::sqrt(bounds.Extents[0] * bounds.Extents[0] + bounds.Extents[1] * bounds.Extents[1] +
+		bounds.Extents[2] * bounds.Extents[2]);
+	return bounds;
+}
+
+FrustumCuller::FrustumCuller()
+	: m_Count(0), m_Stats({ 0, 0, 0 }) {
+}
+
+unsigned int FrustumCuller::Add(const CullBounds& bounds) {
+	unsigned int index = m_Count++;
+	if (index >= m_Radius.size()) {
+		size_t padded = m_Radius.size() + LANES;
+		for (std::vector<float>* array : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius }) {
+			array->resize(padded, 0.0f);
+		}
+	}
+	SetBounds(index, bounds);
+	return index;
+}
+
+void FrustumCuller::SetBounds(unsigned int index, const CullBounds& bounds) {
+	m_CenterX[index] = bounds.Center[0];
+	m_CenterY[index] = bounds.Center[1];
+	m_CenterZ[index] = bounds.Center[2];
+	m_ExtentX[index] = bounds.Extents[0];
+	m_ExtentY[index] = bounds.Extents[1];
+	m_ExtentZ[index] = bounds.Extents[2];
+	m_Radius[index] = bounds.Radius;
+}
+
+void FrustumCuller::Clear() {
+	m_Count = 0;
+	for (std::vector<float>* array : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius }) {
+		array->clear();
+	}
+}
+
+void FrustumCuller::ResetStats() {
+	m_Stats = { 0, 0, 0 };
+}
+
+/* |n| per plane, for the box's projected radius */
+static void GetAbsNormals(const Frustum& frustum, float absNormal[FRUSTUM_PLANE_COUNT][3]) {
+	for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		for (int axis = 0; axis < 3; axis++) {
+			absNormal[p][axis] = std::fabs(frustum.Planes[p].Normal[axis]);
+		}
+	}
+}
+
+/* Objects tested by one pass of the kernel below */
+#if defined(SIMD_AVX)
+static const unsigned int GROUP_SIZE = 8;
+#elif defined(SIMD_SSE)
+static const unsigned int GROUP_SIZE = 4;
+#else
+static const unsigned int GROUP_SIZE = 1;
+#endif
+
+/* Tests objects [first, first + GROUP_SIZE) and returns a bit per object, set if it's at least partly inside */
+static int TestGroup(const Frustum& frustum, const float absNormal[FRUSTUM_PLANE_COUNT][3], const CullArrays& arrays,
+	unsigned int first) {
+#if defined(SIMD_AVX)
+	__m256 cx = _mm256_loadu_ps(arrays.CenterX + first), cy = _mm256_loadu_ps(arrays.CenterY + first), cz = _mm256_loadu_ps(arrays.CenterZ + first);
+	__m256 ex = _mm256_loadu_ps(arrays.ExtentX + first), ey = _mm256_loadu_ps(arrays.ExtentY + first), ez = _mm256_loadu_ps(arrays.ExtentZ + first);
+	__m256 radius = _mm256_loadu_ps(arrays.Radius + first);
+	__m256 culled = _mm256_setzero_ps();
+	for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		const FrustumPlane& plane = frustum.Planes[p];
+		__m256 distance = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.Normal[0])), _mm256_mul_ps(cy, _mm256_set1_ps(plane.Normal[1]))),
+			_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.Normal[2])), _mm256_set1_ps(plane.Distance)));
+		__m256 boxRadius = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(absNormal[p][0])), _mm256_mul_ps(ey, _mm256_set1_ps(absNormal[p][1]))),
+			_mm256_mul_ps(ez, _mm256_set1_ps(absNormal[p][2])));
+		/* Outside if even the nearer of the two reaches doesn't get back across the plane */
+		__m256 reach = _mm256_min_ps(radius, boxRadius);
+		culled = _mm256_or_ps(culled, _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_LT_OQ));
+		if (_mm256_movemask_ps(culled) == 0xFF) {
+			break;
+		}
+	}
+	return ~_mm256_movemask_ps(culled) & 0xFF;
+#elif defined(SIMD_SSE)
+	__m128 cx = _mm_loadu_ps(arrays.CenterX + first), cy = _mm_loadu_ps(arrays.CenterY + first), cz = _mm_loadu_ps(arrays.CenterZ + first);
+	__m128 ex = _mm_loadu_ps(arrays.ExtentX + first), ey = _mm_loadu_ps(arrays.ExtentY + first), ez = _mm_loadu_ps(arrays.ExtentZ + first);
+	__m128 radius = _mm_loadu_ps(arrays.Radius + first);
+	__m128 culled = _mm_setzero_ps();
+	for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		const FrustumPlane& plane = frustum.Planes[p];
+		__m128 distance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.Normal[0])), _mm_mul_ps(cy, _mm_set1_ps(plane.Normal[1]))),
+			_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.Normal[2])), _mm_set1_ps(plane.Distance)));
+		__m128 boxRadius = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(absNormal[p][0])), _mm_mul_ps(ey, _mm_set1_ps(absNormal[p][1]))),
+			_mm_mul_ps(ez, _mm_set1_ps(absNormal[p][2])));
+		/* Outside if even the nearer of the two reaches doesn't get back across the plane */
+		__m128 reach = _mm_min_ps(radius, boxRadius);
+		culled = _mm_or_ps(culled, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+		if (_mm_movemask_ps(culled) == 0xF) {
+			break;
+		}
+	}
+	return ~_mm_movemask_ps(culled) & 0xF;
+#else
+	for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		const FrustumPlane& plane = frustum.Planes[p];
+		float distance = arrays.CenterX[first] * plane.Normal[0] + arrays.CenterY[first] * plane.Normal[1] +
+			arrays.CenterZ[first] * plane.Normal[2] + plane.Distance;
+		float boxRadius = arrays.ExtentX[first] * absNormal[p][0] + arrays.ExtentY[first] * absNormal[p][1] +
+			arrays.ExtentZ[first] * absNormal[p][2];
+		if (distance + std::min(arrays.Radius[first], boxRadius) < 0.0f) {
+			return 0;
+		}
+	}
+	return 1;
+#endif
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, std::vector<unsigned int>& visible) {
+	size_t before = visible.size();
+
+	float absNormal[FRUSTUM_PLANE_COUNT][3];
+	GetAbsNormals(frustum, absNormal);
+	CullArrays arrays = { m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_ExtentX.data(), m_ExtentY.data(),
+		m_ExtentZ.data(), m_Radius.data() };
+	for (unsigned int i = 0; i < m_Count; i += GROUP_SIZE) {
+		int mask = TestGroup(frustum, absNormal, arrays, i);
+		for (unsigned int lane = 0; lane < GROUP_SIZE && i + lane < m_Count; lane++) {
+			if (mask & (1 << lane)) {
+				visible.push_back(i + lane);
+			}
+		}
+	}
+
+	unsigned int visibleCount = (unsigned int)(visible.size() - before);
+	m_Stats.Tested += m_Count;
+	m_Stats.Visible += visibleCount;
+	m_Stats.Culled += m_Count - visibleCount;
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, const CullArrays& arrays, unsigned int count, unsigned char* visible) {
+	float absNormal[FRUSTUM_PLANE_COUNT][3];
+	GetAbsNormals(frustum, absNormal);
+	for (unsigned int i = 0; i < count; i += GROUP_SIZE) {
+		int mask = TestGroup(frustum, absNormal, arrays, i);
+		for (unsigned int lane = 0; lane < GROUP_SIZE && i + lane < count; lane++) {
+			visible[i + lane] = (mask >> lane) & 1;
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "Frustum.h"
+
+/* World space bounds. The sphere and box share a centre, Radius may be tighter than the box's corner */
+struct CullBounds {
+	float Center[3];
+	float Extents[3];   /* Half size of the AABB on each axis */
+	float Radius;
+
+	/* The sphere that just encloses the box */
+	static CullBounds FromBox(const float* min, const float* max);
+};
+
+/* Visibility counts for Cull calls since the last ResetStats */
+struct CullStats {
+	unsigned long long Tested;
+	unsigned long long Visible;
+	unsigned long long Culled;
+};
+
+/* Bounds laid out as FrustumCuller keeps them, one array per member. Each array has to be readable up to the
+ * count rounded up to FrustumCuller::LANES; what's in the padding doesn't matter */
+struct CullArrays {
+	const float* CenterX;
+	const float* CenterY;
+	const float* CenterZ;
+	const float* ExtentX;
+	const float* ExtentY;
+	const float* ExtentZ;
+	const float* Radius;
+};
+
+/* Frustum culling ahead of Renderer submission. Bounds are kept as structure of arrays (all centre x's together,
+ * and so on) so one SIMD instruction tests several objects against a plane: 8 at a time with AVX, 4 with SSE,
+ * one at a time elsewhere. An object is culled when its sphere or its box is wholly outside any plane; the box
+ * test is the usual "positive vertex" one, written as the box's projected radius |n| . extents.
+ * Objects are numbered in the order they're added, and those are the indices Cull hands back.
+ */
+class FrustumCuller {
+public:
+	/* Every array is padded to a whole number of SIMD lanes. Padding has zero bounds and is never reported */
+	static const unsigned int LANES = 8;
+
+private:
+	unsigned int m_Count;
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+	std::vector<float> m_Radius;
+	CullStats m_Stats;
+
+public:
+	FrustumCuller();
+
+	/* Returns the object's index */
+	unsigned int Add(const CullBounds& bounds);
+	void SetBounds(unsigned int index, const CullBounds& bounds);
+	void Clear();
+
+	/* Appends the index of every object at least partly inside the frustum to visible, in index order */
+	void Cull(const Frustum& frustum, std::vector<unsigned int>& visible);
+	/* The same test over bounds kept elsewhere (see DrawList): visible[i] is 1 if object i is at least partly
+	 * inside, 0 if it's culled. Doesn't count towards the stats */
+	static void Cull(const Frustum& frustum, const CullArrays& arrays, unsigned int count, unsigned char* visible);
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline const CullStats& GetStats() const { return m_Stats; }
+	void ResetStats();
+};
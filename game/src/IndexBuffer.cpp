@@ -12,7 +12,29 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 }
 
 IndexBuffer::~IndexBuffer() {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	Release();
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Count(other.m_Count) {
+	other.m_RendererID = 0;
+	other.m_Count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept {
+	if (this != &other) {
+		Release();
+		m_RendererID = other.m_RendererID;
+		m_Count = other.m_Count;
+		other.m_RendererID = 0;
+		other.m_Count = 0;
+	}
+	return *this;
+}
+
+void IndexBuffer::Release() {
+	DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+	m_RendererID = 0;
 }
 
 void IndexBuffer::Bind() const {
@@ -1,13 +1,20 @@
 #pragma once
 
+/* Move-only like VertexBuffer. Moving leaves the source with no buffer and a count of 0 */
 class IndexBuffer {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+
+	void Release();
 public:
 	/* Author uses size for size in bytes, count for element count*/
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
 
 	void Bind() const;
 	void Unbind() const;
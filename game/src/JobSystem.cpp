@@ -0,0 +1,180 @@
+#include "JobSystem.h"
+
+/* Which system and worker the current thread belongs to */
+static thread_local const JobSystem* s_CurrentSystem = nullptr;
+static thread_local unsigned int s_CurrentWorker = JobSystem::NONE;
+/* xorshift state for picking who to steal from */
+static thread_local unsigned int s_StealSeed = 0;
+
+JobSystem::JobSystem(unsigned int workers)
+	: m_Queued(0), m_Sleeping(0), m_Quit(false) {
+	if (workers == 0) {
+		workers = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i = 0; i < workers; i++) {
+		m_Workers.push_back(std::make_unique<Worker>());
+	}
+	s_CurrentSystem = this;
+	s_CurrentWorker = 0;
+	for (unsigned int i = 1; i < workers; i++) {
+		m_Threads.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	m_Quit = true;
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_all();
+	}
+	for (std::thread& thread : m_Threads) {
+		thread.join();
+	}
+	if (s_CurrentSystem == this) {
+		s_CurrentSystem = nullptr;
+		s_CurrentWorker = NONE;
+	}
+}
+
+unsigned int JobSystem::GetWorkerIndex() const {
+	return s_CurrentSystem == this ? s_CurrentWorker : NONE;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobCounter* after) {
+	Job* job = new Job{ std::move(function), counter, true };
+	if (after) {
+		/* Under after's lock, so it can't reach zero and hand out its continuations in between */
+		std::lock_guard<std::mutex> lock(after->m_Mutex);
+		if (after->m_Count.load(std::memory_order_acquire) != 0) {
+			if (counter) {
+				counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+			}
+			after->m_Continuations.push_back(job);
+			return;
+		}
+	}
+	Start(job);
+}
+
+void JobSystem::Start(Job* job) {
+	if (job->Counter) {
+		job->Counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+	}
+	Push(job);
+}
+
+void JobSystem::Push(Job* job) {
+	unsigned int worker = GetWorkerIndex();
+	if (worker != NONE) {
+		m_Workers[worker]->Queue.Push(job);
+	}
+	else {
+		std::lock_guard<std::mutex> lock(m_InjectedMutex);
+		m_Injected.push_back(job);
+	}
+	/* Both seq_cst with the sleeper's side in WorkerMain: either it sees the job, or this sees it sleeping */
+	m_Queued.fetch_add(1);
+	if (m_Sleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_one();
+	}
+}
+
+Job* JobSystem::Take(unsigned int worker) {
+	Job* job = nullptr;
+	if (worker != NONE) {
+		job = m_Workers[worker]->Queue.Pop();
+	}
+	if (!job) {
+		std::lock_guard<std::mutex> lock(m_InjectedMutex);
+		if (!m_Injected.empty()) {
+			job = m_Injected.front();
+			m_Injected.pop_front();
+		}
+	}
+	if (!job) {
+		/* Start from a random victim so thieves don't all pile onto worker 0 */
+		if (s_StealSeed == 0) {
+			s_StealSeed = (unsigned int)std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+		}
+		s_StealSeed ^= s_StealSeed << 13;
+		s_StealSeed ^= s_StealSeed >> 17;
+		s_StealSeed ^= s_StealSeed << 5;
+		unsigned int count = (unsigned int)m_Workers.size();
+		unsigned int start = s_StealSeed % count;
+		for (unsigned int i = 0; i < count && !job; i++) {
+			unsigned int victim = (start + i) % count;
+			if (victim != worker) {
+				job = m_Workers[victim]->Queue.Steal();
+			}
+		}
+	}
+	if (job) {
+		m_Queued.fetch_sub(1);
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job) {
+	job->Function();
+	/* A ParallelFor helper may be gone as soon as the counter drops, so nothing reads the job after this */
+	JobCounter* counter = job->Counter;
+	if (job->HeapAllocated) {
+		delete job;
+	}
+	if (!counter) {
+		return;
+	}
+
+	/* Decremented under the lock: Wait takes it too before returning, so the counter can't be destroyed while
+	 * this still holds it */
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (counter->m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			continuations.swap(counter->m_Continuations);
+		}
+	}
+	for (Job* continuation : continuations) {
+		Push(continuation);
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	unsigned int worker = GetWorkerIndex();
+	while (!counter.IsDone()) {
+		Job* job = Take(worker);
+		if (job) {
+			Execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	/* The last job may still be inside Execute's lock, let it out before the caller destroys the counter */
+	std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::WorkerMain(unsigned int worker) {
+	s_CurrentSystem = this;
+	s_CurrentWorker = worker;
+	unsigned int idle = 0;
+	while (!m_Quit) {
+		Job* job = Take(worker);
+		if (job) {
+			Execute(job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < SPIN_COUNT) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping.fetch_add(1);
+		m_Wake.wait(lock, [this]() { return m_Queued.load() > 0 || m_Quit; });
+		m_Sleeping.fetch_sub(1);
+		idle = 0;
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+class JobSystem;
+struct Job;
+
+/* Counts jobs that haven't finished yet. Run() adds one and finishing takes one away, so JobSystem::Wait on it
+ * waits for everything started against it, and a job Run() with it as "after" starts once it gets to zero.
+ * Don't destroy one until a Wait on it has returned, finishing jobs still touch it up to that point.
+ */
+class JobCounter {
+private:
+	friend class JobSystem;
+
+	std::atomic<unsigned int> m_Count;
+	std::mutex m_Mutex;
+	std::vector<Job*> m_Continuations;   /* Queued when m_Count reaches 0 */
+
+public:
+	JobCounter() : m_Count(0) {}
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+};
+
+/* Run() wraps each function in one of these until it has run */
+struct Job {
+	std::function<void()> Function;
+	JobCounter* Counter;
+	bool HeapAllocated;   /* Deleted once it has run. ParallelFor's live on its stack instead */
+};
+
+/* A fixed pool of worker threads sharing small jobs.
+ * Each worker has its own Chase-Lev deque: it pushes and pops its own jobs at one end without locking, and a
+ * worker that runs dry steals from the other end of someone else's. The thread that creates the system is
+ * worker 0 and only runs jobs while it's in Wait(), so waiting is never idle time. Jobs queued from a thread that
+ * isn't a worker go through one locked queue.
+ * Workers with nothing to do spin briefly, then sleep until something is queued.
+ */
+class JobSystem {
+private:
+	struct Worker {
+		WorkStealingDeque<Job> Queue;
+	};
+
+	/* Steal attempts before a worker gives up and sleeps */
+	static const unsigned int SPIN_COUNT = 64;
+	/* Most jobs one ParallelFor starts, besides the calling thread's share */
+	static const unsigned int MAX_HELPERS = 63;
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_InjectedMutex;
+	std::deque<Job*> m_Injected;
+
+	/* Queued and not yet picked up, so sleepers know whether there's anything worth waking for */
+	std::atomic<unsigned int> m_Queued;
+	std::atomic<unsigned int> m_Sleeping;
+	std::atomic<bool> m_Quit;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_Wake;
+
+	/* This thread's worker number in this system, NONE for other threads */
+	unsigned int GetWorkerIndex() const;
+	/* Counts the job against its counter and queues it */
+	void Start(Job* job);
+	void Push(Job* job);
+	Job* Take(unsigned int worker);
+	void Execute(Job* job);
+	void WorkerMain(unsigned int worker);
+
+public:
+	static const unsigned int NONE = 0xffffffff;
+
+	/* 0 means one worker per hardware thread. The calling thread counts as one of them */
+	JobSystem(unsigned int workers = 0);
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/* Queues function. counter (if any) covers it until it has run. With after, it isn't queued until after
+	 * reaches zero, which is how a job depends on others */
+	void Run(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* after = nullptr);
+	/* Runs queued jobs until counter reaches zero. Fine to call from inside a job */
+	void Wait(JobCounter& counter);
+
+	/* f(begin, end) over [begin, end) in pieces of at most grain, returning once they've all run. The calling thread
+	 * takes part, and with one worker or one piece it's just a call.
+	 * Rather than a job per piece, up to one job per other worker claims pieces from a shared cursor until there
+	 * are none left. Those jobs live on this stack frame and their functions capture one reference, which
+	 * std::function stores inline, so a ParallelFor doesn't allocate */
+	template<typename F>
+	void ParallelFor(unsigned int begin, unsigned int end, unsigned int grain, const F& f) {
+		grain = std::max(grain, 1u);
+		if (end <= begin) {
+			return;
+		}
+		unsigned int pieces = (end - begin + grain - 1) / grain;
+		if (m_Workers.size() == 1 || pieces == 1) {
+			f(begin, end);
+			return;
+		}
+
+		std::atomic<unsigned int> next(begin);
+		auto claim = [&next, end, grain, &f]() {
+			for (unsigned int first = next.fetch_add(grain); first < end; first = next.fetch_add(grain)) {
+				f(first, std::min(end, first + grain));
+			}
+		};
+
+		JobCounter counter;
+		Job helpers[MAX_HELPERS];
+		unsigned int helperCount = std::min({ pieces - 1, GetWorkerCount() - 1, MAX_HELPERS });
+		for (unsigned int i = 0; i < helperCount; i++) {
+			helpers[i].Function = [&claim]() { claim(); };
+			helpers[i].Counter = &counter;
+			helpers[i].HeapAllocated = false;
+			Start(&helpers[i]);
+		}
+		claim();
+		Wait(counter);
+	}
+
+	inline unsigned int GetWorkerCount() const { return (unsigned int)m_Workers.size(); }
+};
@@ -0,0 +1,70 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+#include <new>
+
+/* Blocks start on a cache line, so nothing allocated first straddles one needlessly */
+static const size_t BLOCK_ALIGNMENT = 64;
+
+LinearArena::LinearArena(size_t blockSize)
+	: m_BlockSize(blockSize), m_Block(0), m_Offset(0), m_Used(0) {
+}
+
+LinearArena::~LinearArena() {
+	FreeBlocks();
+}
+
+void LinearArena::AddBlock(size_t size) {
+	m_Blocks.push_back({ (unsigned char*)operator new(size, std::align_val_t(BLOCK_ALIGNMENT)), size });
+}
+
+void LinearArena::FreeBlocks() {
+	for (Block& block : m_Blocks) {
+		operator delete(block.Data, std::align_val_t(BLOCK_ALIGNMENT));
+	}
+	m_Blocks.clear();
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) {
+	while (true) {
+		if (m_Block < m_Blocks.size()) {
+			const Block& block = m_Blocks[m_Block];
+			size_t start = (m_Offset + alignment - 1) / alignment * alignment;
+			if (start + size <= block.Size) {
+				m_Used += start + size - m_Offset;
+				m_Offset = start + size;
+				return block.Data + start;
+			}
+			/* Whatever's left of this block is wasted until the next Reset */
+			m_Used += block.Size - m_Offset;
+			if (m_Block + 1 < m_Blocks.size()) {
+				m_Block++;
+				m_Offset = 0;
+				continue;
+			}
+			m_Block++;
+		}
+		/* Big enough for this allocation even when it's bigger than the usual block */
+		AddBlock(std::max(m_BlockSize, size + alignment));
+		m_Offset = 0;
+	}
+}
+
+void LinearArena::Reset() {
+	if (m_Blocks.size() > 1) {
+		size_t total = GetCapacity();
+		FreeBlocks();
+		AddBlock(total);
+	}
+	m_Block = 0;
+	m_Offset = 0;
+	m_Used = 0;
+}
+
+size_t LinearArena::GetCapacity() const {
+	size_t capacity = 0;
+	for (const Block& block : m_Blocks) {
+		capacity += block.Size;
+	}
+	return capacity;
+}
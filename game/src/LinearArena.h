@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/* Bump pointer allocator: Allocate() rounds the offset up to the alignment and moves it along, and Reset()
+ * frees everything at once by moving it back. Nothing is freed individually and no destructors run, so only put
+ * trivially destructible data in here.
+ * When a block runs out another is chained on. Reset() then swaps the chain for one block of the combined size,
+ * so a workload that repeats (a frame, say) settles into a single block and stops allocating.
+ * Not thread safe, see FrameAllocator for one per thread.
+ */
+class LinearArena {
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+private:
+	struct Block {
+		unsigned char* Data;
+		size_t Size;
+	};
+
+	std::vector<Block> m_Blocks;
+	size_t m_BlockSize;
+	size_t m_Block;    /* Current block */
+	size_t m_Offset;   /* Into the current block */
+	size_t m_Used;
+
+	void AddBlock(size_t size);
+	void FreeBlocks();
+
+public:
+	LinearArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~LinearArena();
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	/* Uninitialised. Never nullptr */
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	/* Room for count Ts, not constructed */
+	template<typename T>
+	inline T* Allocate(size_t count = 1) {
+		static_assert(std::is_trivially_destructible<T>::value, "Arena memory is dropped without running destructors");
+		return (T*)Allocate(sizeof(T) * count, alignof(T));
+	}
+
+	void Reset();
+
+	/* Bytes handed out since the last Reset, padding included */
+	inline size_t GetUsed() const { return m_Used; }
+	size_t GetCapacity() const;
+};
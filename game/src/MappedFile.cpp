@@ -0,0 +1,85 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+MappedFile::MappedFile(const std::string& filePath)
+	: m_Data(nullptr), m_Size(0), m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr) {
+	m_File = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0) {
+		/* Mapping a zero length file fails, it just has no text */
+		return;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping) {
+		return;
+	}
+	m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_Data) {
+		m_Size = (size_t)size.QuadPart;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (m_Data) {
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping) {
+		CloseHandle(m_Mapping);
+	}
+	if (m_File != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_File);
+	}
+}
+
+bool MappedFile::IsOpen() const {
+	return m_File != INVALID_HANDLE_VALUE;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filePath)
+	: m_Data(nullptr), m_Size(0), m_File(-1) {
+	m_File = open(filePath.c_str(), O_RDONLY);
+	if (m_File == -1) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(m_File, &info) != 0 || info.st_size == 0) {
+		return;
+	}
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_File, 0);
+	if (data != MAP_FAILED) {
+		m_Data = (const char*)data;
+		m_Size = (size_t)info.st_size;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (m_Data) {
+		munmap((void*)m_Data, m_Size);
+	}
+	if (m_File != -1) {
+		close(m_File);
+	}
+}
+
+bool MappedFile::IsOpen() const {
+	return m_File != -1;
+}
+#endif
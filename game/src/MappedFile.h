@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/* Read only memory map of a whole file. The OS pages it in as it's read, nothing is copied into our own buffers.
+ * Views into GetText() are only valid while the MappedFile is alive.
+ */
+class MappedFile {
+private:
+	const char* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#else
+	int m_File;
+#endif
+
+public:
+	MappedFile(const std::string& filePath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/* False if the file couldn't be opened. An empty file is open but has no text */
+	bool IsOpen() const;
+	inline std::string_view GetText() const { return std::string_view(m_Data, m_Size); }
+};
@@ -0,0 +1,159 @@
+#include "Material.h"
+#include "Renderer.h"
+#include "ResourceRegistry.h"
+
+#include <cstring>
+
+unsigned int Material::s_NextID = 1;
+
+/* Default block types ApplyParameter has a Shader setter for */
+static bool CanApply(unsigned int type) {
+	switch (type) {
+		case GL_INT:
+		case GL_BOOL:
+		case GL_FLOAT:
+		case GL_FLOAT_VEC2:
+		case GL_FLOAT_VEC3:
+		case GL_FLOAT_VEC4:
+		case GL_FLOAT_MAT3:
+		case GL_FLOAT_MAT4:
+			return true;
+	}
+	return false;
+}
+
+Material::Material(const ResourceRegistry& resources, ResourceHandle<Shader> shader)
+	: m_Shader(shader), m_ID(s_NextID++), m_BlockDirty(false) {
+	const Shader* program = resources.Get(shader);
+	ASSERT(program);
+	const ShaderReflection& reflection = program->GetReflection();
+
+	const ShaderUniformBlockInfo* block = reflection.FindUniformBlock("MaterialConstants");
+	if (block) {
+		m_Block = std::make_unique<UniformBuffer>(block->DataSize);
+		m_BlockData.resize(block->DataSize);
+		m_BlockDirty = true;
+	}
+
+	for (const ShaderUniformInfo& info : reflection.Uniforms) {
+		unsigned int size = ShaderReflection::GetSizeOfType(info.Type) * info.Size;
+		if (info.BlockIndex == -1) {
+			if (ShaderReflection::IsSamplerType(info.Type)) {
+				/* Texture units are bound by whoever owns the textures, not the material */
+				continue;
+			}
+			if (!CanApply(info.Type)) {
+				std::cout << "Warning: material can't set uniform '" << info.Name << "', set it on the shader instead" << std::endl;
+				continue;
+			}
+			m_Parameters.push_back({ info.ID, info.Type, (unsigned int)info.Size, (unsigned int)m_Data.size(), size, false, false });
+			m_Data.resize(m_Data.size() + size);
+		}
+		else if (block && (unsigned int)info.BlockIndex == block->Index) {
+			m_Parameters.push_back({ info.ID, info.Type, (unsigned int)info.Size, (unsigned int)info.Offset, size, true, false });
+		}
+	}
+}
+
+void Material::SetUniform1i(UniformID uniform, int value) {
+	SetParameter(uniform, GL_INT, &value, sizeof(value));
+}
+
+void Material::SetUniform1f(UniformID uniform, float value) {
+	SetParameter(uniform, GL_FLOAT, &value, sizeof(value));
+}
+
+void Material::SetUniform2f(UniformID uniform, float v0, float v1) {
+	const float value[] = { v0, v1 };
+	SetParameter(uniform, GL_FLOAT_VEC2, value, sizeof(value));
+}
+
+void Material::SetUniform3f(UniformID uniform, float v0, float v1, float v2) {
+	const float value[] = { v0, v1, v2 };
+	SetParameter(uniform, GL_FLOAT_VEC3, value, sizeof(value));
+}
+
+void Material::SetUniform4f(UniformID uniform, float v0, float v1, float v2, float v3) {
+	const float value[] = { v0, v1, v2, v3 };
+	SetParameter(uniform, GL_FLOAT_VEC4, value, sizeof(value));
+}
+
+void Material::SetUniformMat3f(UniformID uniform, const float* matrix) {
+	SetParameter(uniform, GL_FLOAT_MAT3, matrix, 9 * sizeof(float));
+}
+
+void Material::SetUniformMat4f(UniformID uniform, const float* matrix) {
+	SetParameter(uniform, GL_FLOAT_MAT4, matrix, 16 * sizeof(float));
+}
+
+void Material::SetParameter(UniformID uniform, unsigned int type, const void* data, unsigned int size) {
+	/* Materials have a handful of parameters, a scan beats hashing */
+	for (Parameter& parameter : m_Parameters) {
+		if (parameter.ID.GetIndex() != uniform.GetIndex()) {
+			continue;
+		}
+		ASSERT(parameter.Type == type || (type == GL_INT && parameter.Type == GL_BOOL));
+		ASSERT(size <= parameter.Size);
+		if (parameter.InBlock) {
+			if (memcmp(m_BlockData.data() + parameter.Offset, data, size) != 0) {
+				memcpy(m_BlockData.data() + parameter.Offset, data, size);
+				m_BlockDirty = true;
+			}
+		}
+		else {
+			memcpy(m_Data.data() + parameter.Offset, data, size);
+			parameter.Set = true;
+		}
+		return;
+	}
+	std::cout << "Warning: material has no parameter '" << uniform.GetName() << "'" << std::endl;
+}
+
+bool Material::Apply(ResourceRegistry& resources) {
+	Shader* shader = resources.Get(m_Shader);
+	if (!shader) {
+		return false;
+	}
+	shader->Bind();
+
+	for (const Parameter& parameter : m_Parameters) {
+		if (!parameter.InBlock && parameter.Set) {
+			ApplyParameter(*shader, parameter);
+		}
+	}
+
+	if (m_Block) {
+		if (m_BlockDirty) {
+			m_Block->SetData(m_BlockData.data(), (unsigned int)m_BlockData.size());
+			m_BlockDirty = false;
+		}
+		m_Block->BindBase(MATERIAL_CONSTANTS_BINDING);
+	}
+	return true;
+}
+
+/* The Shader setters compare against what the program already holds, so unchanged values cost no GL call */
+void Material::ApplyParameter(Shader& shader, const Parameter& parameter) {
+	const unsigned char* data = m_Data.data() + parameter.Offset;
+	const float* floats = (const float*)data;
+	switch (parameter.Type) {
+		case GL_INT:
+		case GL_BOOL:
+			shader.SetUniform1iv(parameter.ID, parameter.Count, (const int*)data); break;
+		case GL_FLOAT:
+			shader.SetUniform1fv(parameter.ID, parameter.Count, floats); break;
+		case GL_FLOAT_VEC2:
+			shader.SetUniform2fv(parameter.ID, parameter.Count, floats); break;
+		case GL_FLOAT_VEC3:
+			shader.SetUniform3fv(parameter.ID, parameter.Count, floats); break;
+		case GL_FLOAT_VEC4:
+			shader.SetUniform4fv(parameter.ID, parameter.Count, floats); break;
+		case GL_FLOAT_MAT3:
+			shader.SetUniformMat3fv(parameter.ID, parameter.Count, floats); break;
+		case GL_FLOAT_MAT4:
+			shader.SetUniformMat4fv(parameter.ID, parameter.Count, floats); break;
+		default:
+			/* The constructor only keeps types CanApply accepts */
+			ASSERT(false);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ResourceHandle.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+#include "UniformID.h"
+
+class ResourceRegistry;
+
+/* Material = shader + uniforms.
+ * Parameter values are packed into one block laid out from the shader's reflection. Apply() pushes them with as
+ * few GL calls as possible: default block uniforms go through Shader's shadow copies, so only values that differ
+ * from what the program already holds are sent, and a MaterialConstants block is re-uploaded only when dirty.
+ * Draws are sorted by GetSortKey() to group them by program, then material.
+ * The shader is a handle into the ResourceRegistry rather than a reference, so materials can live in a
+ * ResourcePool themselves and a material whose shader has been destroyed is caught rather than left dangling.
+ */
+class Material {
+private:
+	struct Parameter {
+		UniformID ID;
+		unsigned int Type;
+		unsigned int Count;
+		unsigned int Offset;  /* Into m_Data, or into the block for block members */
+		unsigned int Size;
+		bool InBlock;
+		bool Set;             /* Default block only. Never set means never uploaded, so GLSL initialisers survive */
+	};
+
+	ResourceHandle<Shader> m_Shader;
+	unsigned int m_ID;
+	std::vector<Parameter> m_Parameters;
+	std::vector<unsigned char> m_Data;
+	/* Only created when the shader declares a MaterialConstants block */
+	std::unique_ptr<UniformBuffer> m_Block;
+	std::vector<unsigned char> m_BlockData;
+	bool m_BlockDirty;
+
+	static unsigned int s_NextID;
+
+	void SetParameter(UniformID uniform, unsigned int type, const void* data, unsigned int size);
+	void ApplyParameter(Shader& shader, const Parameter& parameter);
+
+public:
+	/* shader has to be live, its reflection decides the parameters */
+	Material(const ResourceRegistry& resources, ResourceHandle<Shader> shader);
+
+	void SetUniform1i(UniformID uniform, int value);
+	void SetUniform1f(UniformID uniform, float value);
+	void SetUniform2f(UniformID uniform, float v0, float v1);
+	void SetUniform3f(UniformID uniform, float v0, float v1, float v2);
+	void SetUniform4f(UniformID uniform, float v0, float v1, float v2, float v3);
+	void SetUniformMat3f(UniformID uniform, const float* matrix);
+	void SetUniformMat4f(UniformID uniform, const float* matrix);
+
+	/* Binds the shader and gets every parameter that's been set onto the GPU.
+	 * False, with nothing bound, if the shader has been destroyed since */
+	bool Apply(ResourceRegistry& resources);
+
+	inline ResourceHandle<Shader> GetShader() const { return m_Shader; }
+	inline unsigned int GetID() const { return m_ID; }
+	/* Shader in the high bits so a sorted queue changes program as rarely as possible. ShaderLibrary gives each
+	 * program one handle, so equal handles are the same program */
+	inline unsigned long long GetSortKey() const {
+		return ((unsigned long long)m_Shader.Value << 32) | m_ID;
+	}
+};
@@ -0,0 +1,274 @@
+#include "Matrix.h"
+
+#include <cmath>
+
+#include "Simd.h"
+
+#if defined(SIMD_SSE)
+/* Each component of v broadcast to all four lanes */
+#define SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+/* The pieces below are 2x2 matrices packed into one register as (m00, m01, m10, m11) */
+#define SWIZZLE(v, a, b, c, d) _mm_shuffle_ps(v, v, _MM_SHUFFLE(d, c, b, a))
+#define SHUFFLE(v1, v2, a, b, c, d) _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(d, c, b, a))
+
+/* a * b */
+static inline __m128 Mat2Multiply(__m128 a, __m128 b) {
+	return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/* adjugate(a) * b */
+static inline __m128 Mat2AdjugateMultiply(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/* a * adjugate(b) */
+static inline __m128 Mat2MultiplyAdjugate(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+#endif
+
+Mat4 Mat4::Identity() {
+	return { {
+		{ 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 1.0f }
+	} };
+}
+
+Mat4 Mat4::Translation(const Vec3& offset) {
+	Mat4 result = Identity();
+	result.Columns[3] = { offset.x, offset.y, offset.z, 1.0f };
+	return result;
+}
+
+Mat4 Mat4::Scale(const Vec3& scale) {
+	Mat4 result = Identity();
+	result.Columns[0].x = scale.x;
+	result.Columns[1].y = scale.y;
+	result.Columns[2].z = scale.z;
+	return result;
+}
+
+Mat4 Mat4::Rotation(const Quat& q) {
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	return { {
+		{ 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f },
+		{ 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f },
+		{ 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 1.0f }
+	} };
+}
+
+Mat4 Mat4::FromTRS(const Vec3& translation, const Quat& rotation, const Vec3& scale) {
+	/* Scaling the rotation's columns is the same as multiplying by a scale matrix on the right */
+	Mat4 result = Rotation(rotation);
+	result.Columns[0] = result.Columns[0] * scale.x;
+	result.Columns[1] = result.Columns[1] * scale.y;
+	result.Columns[2] = result.Columns[2] * scale.z;
+	result.Columns[3] = { translation.x, translation.y, translation.z, 1.0f };
+	return result;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float nearPlane, float farPlane) {
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	float depth = nearPlane - farPlane;
+	return { {
+		{ f / aspect, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, (farPlane + nearPlane) / depth, -1.0f },
+		{ 0.0f, 0.0f, 2.0f * farPlane * nearPlane / depth, 0.0f }
+	} };
+}
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane) {
+	float width = right - left;
+	float height = top - bottom;
+	float depth = farPlane - nearPlane;
+	return { {
+		{ 2.0f / width, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 2.0f / height, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, -2.0f / depth, 0.0f },
+		{ -(right + left) / width, -(top + bottom) / height, -(farPlane + nearPlane) / depth, 1.0f }
+	} };
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up) {
+	Vec3 forward = Normalize(target - eye);
+	Vec3 side = Normalize(Cross(forward, up));
+	Vec3 cameraUp = Cross(side, forward);
+	return { {
+		{ side.x, cameraUp.x, -forward.x, 0.0f },
+		{ side.y, cameraUp.y, -forward.y, 0.0f },
+		{ side.z, cameraUp.z, -forward.z, 0.0f },
+		{ -Dot(side, eye), -Dot(cameraUp, eye), Dot(forward, eye), 1.0f }
+	} };
+}
+
+Mat4 Mat4::Transposed() const {
+	Mat4 result;
+#if defined(SIMD_SSE)
+	__m128 c0 = _mm_load_ps(&Columns[0].x);
+	__m128 c1 = _mm_load_ps(&Columns[1].x);
+	__m128 c2 = _mm_load_ps(&Columns[2].x);
+	__m128 c3 = _mm_load_ps(&Columns[3].x);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	_mm_store_ps(&result.Columns[0].x, c0);
+	_mm_store_ps(&result.Columns[1].x, c1);
+	_mm_store_ps(&result.Columns[2].x, c2);
+	_mm_store_ps(&result.Columns[3].x, c3);
+#else
+	const float* in = GetData();
+	float* out = result.GetData();
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			out[row * 4 + column] = in[column * 4 + row];
+		}
+	}
+#endif
+	return result;
+}
+
+Mat4 Mat4::Inverse() const {
+	Mat4 result;
+#if defined(SIMD_SSE)
+	/* Block inverse on 2x2 sub matrices
+	 *     | A B |        1   | W# -Y# |
+	 * M = | C D |, M^-1 = --- | -Z# X# |
+	 *                    |M|
+	 * with X# = |D|A - B(D#C), W# = |A|D - C(A#B), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+	 * and |M| = |A||D| + |B||C| - tr((A#B)(D#C)), # being the adjugate.
+	 * It's written for rows, but inverting the transpose and reading the answer back as columns is the same thing.
+	 */
+	__m128 c0 = _mm_load_ps(&Columns[0].x);
+	__m128 c1 = _mm_load_ps(&Columns[1].x);
+	__m128 c2 = _mm_load_ps(&Columns[2].x);
+	__m128 c3 = _mm_load_ps(&Columns[3].x);
+
+	__m128 a = _mm_movelh_ps(c0, c1);
+	__m128 b = _mm_movehl_ps(c1, c0);
+	__m128 c = _mm_movelh_ps(c2, c3);
+	__m128 d = _mm_movehl_ps(c3, c2);
+
+	/* (|A|, |B|, |C|, |D|) */
+	__m128 determinants = _mm_sub_ps(
+		_mm_mul_ps(SHUFFLE(c0, c2, 0, 2, 0, 2), SHUFFLE(c1, c3, 1, 3, 1, 3)),
+		_mm_mul_ps(SHUFFLE(c0, c2, 1, 3, 1, 3), SHUFFLE(c1, c3, 0, 2, 0, 2)));
+	__m128 detA = SPLAT(determinants, 0);
+	__m128 detB = SPLAT(determinants, 1);
+	__m128 detC = SPLAT(determinants, 2);
+	__m128 detD = SPLAT(determinants, 3);
+
+	__m128 dc = Mat2AdjugateMultiply(d, c);
+	__m128 ab = Mat2AdjugateMultiply(a, b);
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Multiply(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Multiply(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MultiplyAdjugate(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MultiplyAdjugate(a, dc));
+
+	/* Horizontal sum without SSE3's hadd */
+	__m128 trace = _mm_mul_ps(ab, SWIZZLE(dc, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+	/* The adjugate's sign pattern folded into the divide */
+	__m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	x = _mm_mul_ps(x, scale);
+	y = _mm_mul_ps(y, scale);
+	z = _mm_mul_ps(z, scale);
+	w = _mm_mul_ps(w, scale);
+
+	/* The final adjugate swizzle and the write out in one shuffle per column */
+	_mm_store_ps(&result.Columns[0].x, SHUFFLE(x, y, 3, 1, 3, 1));
+	_mm_store_ps(&result.Columns[1].x, SHUFFLE(x, y, 2, 0, 2, 0));
+	_mm_store_ps(&result.Columns[2].x, SHUFFLE(z, w, 3, 1, 3, 1));
+	_mm_store_ps(&result.Columns[3].x, SHUFFLE(z, w, 2, 0, 2, 0));
+#else
+	/* Cofactor expansion, 2x2 determinants of the top and bottom halves shared between the 3x3 minors */
+	const float* m = GetData();
+	float s0 = m[0] * m[5] - m[4] * m[1];
+	float s1 = m[0] * m[6] - m[4] * m[2];
+	float s2 = m[0] * m[7] - m[4] * m[3];
+	float s3 = m[1] * m[6] - m[5] * m[2];
+	float s4 = m[1] * m[7] - m[5] * m[3];
+	float s5 = m[2] * m[7] - m[6] * m[3];
+	float c5 = m[10] * m[15] - m[14] * m[11];
+	float c4 = m[9] * m[15] - m[13] * m[11];
+	float c3 = m[9] * m[14] - m[13] * m[10];
+	float c2 = m[8] * m[15] - m[12] * m[11];
+	float c1 = m[8] * m[14] - m[12] * m[10];
+	float c0 = m[8] * m[13] - m[12] * m[9];
+	float scale = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+	float* out = result.GetData();
+	out[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * scale;
+	out[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * scale;
+	out[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * scale;
+	out[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * scale;
+	out[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * scale;
+	out[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * scale;
+	out[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * scale;
+	out[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * scale;
+	out[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * scale;
+	out[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * scale;
+	out[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * scale;
+	out[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * scale;
+	out[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * scale;
+	out[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * scale;
+	out[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * scale;
+	out[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * scale;
+#endif
+	return result;
+}
+
+Vec3 Mat4::TransformPoint(const Vec3& point) const {
+	Vec4 result = *this * Vec4{ point.x, point.y, point.z, 1.0f };
+	return { result.x, result.y, result.z };
+}
+
+Vec3 Mat4::TransformDirection(const Vec3& direction) const {
+	Vec4 result = *this * Vec4{ direction.x, direction.y, direction.z, 0.0f };
+	return { result.x, result.y, result.z };
+}
+
+Mat4 operator*(const Mat4& a, const Mat4& b) {
+	Mat4 result;
+#if defined(SIMD_SSE)
+	/* Each result column is a's columns weighted by one of b's */
+	__m128 a0 = _mm_load_ps(&a.Columns[0].x);
+	__m128 a1 = _mm_load_ps(&a.Columns[1].x);
+	__m128 a2 = _mm_load_ps(&a.Columns[2].x);
+	__m128 a3 = _mm_load_ps(&a.Columns[3].x);
+	for (int column = 0; column < 4; column++) {
+		__m128 bc = _mm_load_ps(&b.Columns[column].x);
+		__m128 sum = _mm_mul_ps(a0, SPLAT(bc, 0));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a1, SPLAT(bc, 1)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a2, SPLAT(bc, 2)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a3, SPLAT(bc, 3)));
+		_mm_store_ps(&result.Columns[column].x, sum);
+	}
+#else
+	for (int column = 0; column < 4; column++) {
+		result.Columns[column] = a * b.Columns[column];
+	}
+#endif
+	return result;
+}
+
+Vec4 operator*(const Mat4& m, const Vec4& v) {
+#if defined(SIMD_SSE)
+	Vec4 result;
+	__m128 vv = _mm_load_ps(&v.x);
+	__m128 sum = _mm_mul_ps(_mm_load_ps(&m.Columns[0].x), SPLAT(vv, 0));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m.Columns[1].x), SPLAT(vv, 1)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m.Columns[2].x), SPLAT(vv, 2)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m.Columns[3].x), SPLAT(vv, 3)));
+	_mm_store_ps(&result.x, sum);
+	return result;
+#else
+	return m.Columns[0] * v.x + m.Columns[1] * v.y + m.Columns[2] * v.z + m.Columns[3] * v.w;
+#endif
+}
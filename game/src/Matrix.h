@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Quaternion.h"
+#include "UniformBlocks.h"
+#include "Vector.h"
+
+/* 4x4 float matrix, column major and 16 byte aligned: the same 64 bytes glUniformMatrix4fv(..., GL_FALSE, ...)
+ * and a std140 mat4 expect, so GetData() and ToStd140() are straight copies.
+ * Vectors are columns, so a * b applies b first and a projection * view * model chain reads right to left.
+ * Clip space follows GL, z in [-1, 1].
+ */
+struct alignas(16) Mat4 {
+	Vec4 Columns[4];
+
+	static Mat4 Identity();
+	static Mat4 Translation(const Vec3& offset);
+	static Mat4 Scale(const Vec3& scale);
+	static Mat4 Rotation(const Quat& rotation);
+	/* Translation * Rotation * Scale in one go, the usual object to parent transform */
+	static Mat4 FromTRS(const Vec3& translation, const Quat& rotation, const Vec3& scale);
+
+	static Mat4 Perspective(float fovY, float aspect, float nearPlane, float farPlane);
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
+	/* View matrix for a camera at eye looking at target, right handed like GL */
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+
+	Mat4 Transposed() const;
+	/* General inverse. A singular matrix gives infs/NaNs rather than an assert */
+	Mat4 Inverse() const;
+
+	/* w = 1, the result isn't divided by w */
+	Vec3 TransformPoint(const Vec3& point) const;
+	/* w = 0, ignores translation */
+	Vec3 TransformDirection(const Vec3& direction) const;
+
+	inline const float* GetData() const { return &Columns[0].x; }
+	inline float* GetData() { return &Columns[0].x; }
+
+	inline Std140Mat4 ToStd140() const {
+		Std140Mat4 result;
+		for (int column = 0; column < 4; column++) {
+			result.Columns[column] = { Columns[column].x, Columns[column].y, Columns[column].z, Columns[column].w };
+		}
+		return result;
+	}
+};
+
+static_assert(sizeof(Mat4) == sizeof(Std140Mat4), "Mat4 must upload as a std140 mat4 without repacking");
+
+Mat4 operator*(const Mat4& a, const Mat4& b);
+Vec4 operator*(const Mat4& m, const Vec4& v);
@@ -0,0 +1,62 @@
+#include "Quaternion.h"
+
+#include <cmath>
+
+Quat Quat::FromAxisAngle(const Vec3& axis, float radians) {
+	float s = std::sin(radians * 0.5f);
+	return { axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f) };
+}
+
+Quat Quat::FromEuler(float pitch, float yaw, float roll) {
+	return FromAxisAngle({ 0.0f, 1.0f, 0.0f }, yaw) * FromAxisAngle({ 1.0f, 0.0f, 0.0f }, pitch) *
+		FromAxisAngle({ 0.0f, 0.0f, 1.0f }, roll);
+}
+
+Quat Quat::Normalized() const {
+	float scale = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+	return { x * scale, y * scale, z * scale, w * scale };
+}
+
+Vec3 Quat::Rotate(const Vec3& v) const {
+	/* v + 2w(q x v) + 2q x (q x v), cheaper than q * v * q^-1 */
+	Vec3 q = { x, y, z };
+	Vec3 t = Cross(q, v) * 2.0f;
+	return v + t * w + Cross(q, t);
+}
+
+Quat Quat::Slerp(const Quat& a, const Quat& b, float t) {
+	float cosTheta = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	/* q and -q are the same rotation, flip one to take the short way round */
+	float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+	cosTheta *= sign;
+
+	float weightA, weightB;
+	/* Nearly parallel, sin(theta) goes to 0, so lerp and renormalise */
+	if (cosTheta > 0.9995f) {
+		weightA = 1.0f - t;
+		weightB = t;
+	}
+	else {
+		float theta = std::acos(cosTheta);
+		float sinTheta = std::sin(theta);
+		weightA = std::sin((1.0f - t) * theta) / sinTheta;
+		weightB = std::sin(t * theta) / sinTheta;
+	}
+	weightB *= sign;
+	Quat result = {
+		a.x * weightA + b.x * weightB,
+		a.y * weightA + b.y * weightB,
+		a.z * weightA + b.z * weightB,
+		a.w * weightA + b.w * weightB
+	};
+	return result.Normalized();
+}
+
+Quat operator*(const Quat& a, const Quat& b) {
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Vector.h"
+
+/* Unit quaternion rotation, x/y/z the vector part and w the scalar part. a * b applies b first, like matrices */
+struct alignas(16) Quat {
+	float x, y, z, w;
+
+	static inline Quat Identity() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+	/* Axis must be normalised. Positive angles are counter clockwise looking down the axis */
+	static Quat FromAxisAngle(const Vec3& axis, float radians);
+	/* Applied as z, then x, then y: roll, pitch, then yaw */
+	static Quat FromEuler(float pitch, float yaw, float roll);
+
+	inline Quat Conjugate() const { return { -x, -y, -z, w }; }
+	Quat Normalized() const;
+	Vec3 Rotate(const Vec3& v) const;
+
+	/* Shortest path, t in [0, 1] */
+	static Quat Slerp(const Quat& a, const Quat& b, float t);
+};
+
+Quat operator*(const Quat& a, const Quat& b);
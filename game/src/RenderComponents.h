@@ -0,0 +1,32 @@
+#pragma once
+
+#include "FrustumCuller.h"
+#include "Matrix.h"
+#include "ResourcePool.h"
+
+class VertexArray;
+class IndexBuffer;
+class Material;
+
+/* Components for anything DrawList should draw. Plain data only (see GetComponentType), so resources are
+ * referenced, not owned. Meshes and materials are handles into the ResourceRegistry, so destroying one early just
+ * drops the draw rather than leaving a dangling pointer */
+
+struct Transform {
+	Mat4 World;
+};
+
+struct MeshRef {
+	ResourceHandle<VertexArray> Vertices;
+	ResourceHandle<IndexBuffer> Indices;
+};
+
+struct MaterialRef {
+	ResourceHandle<Material> Instance;
+};
+
+/* World space, kept in step with Transform by whatever moves the entity. Change it through DrawList::SetBounds,
+ * which also refits DrawList's tree */
+struct Bounds {
+	CullBounds World;
+};
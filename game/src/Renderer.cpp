@@ -1,5 +1,16 @@
 #include "Renderer.h"
 
+/* Generated before every build by shadertool reflect */
+#include "generated/ShaderBindings.h"
+
+/* The blocks Renderer uploads have to match what the shaders declare, not just the std140 rules */
+STD140_CHECK_OFFSET(FrameConstants, ViewProjection, offsetof(ShaderBlocks::FrameConstants, ViewProjection));
+STD140_CHECK_OFFSET(FrameConstants, Time, offsetof(ShaderBlocks::FrameConstants, Time));
+STD140_CHECK_OFFSET(FrameConstants, DeltaTime, offsetof(ShaderBlocks::FrameConstants, DeltaTime));
+STD140_CHECK_BLOCK(FrameConstants, sizeof(ShaderBlocks::FrameConstants));
+STD140_CHECK_OFFSET(ObjectConstants, Model, offsetof(ShaderBlocks::ObjectConstants, Model));
+STD140_CHECK_BLOCK(ObjectConstants, sizeof(ShaderBlocks::ObjectConstants));
+
 void GLClearError() {
 	/* Read error buffer until no flags returned */
 	while (glGetError() != GL_NO_ERROR);
@@ -15,12 +26,39 @@ bool GLLogCall(const char* function, const char* file, int line) {
 	return true;
 }
 
+/* Enough for a few thousand draws a frame at the usual 256 byte offset alignment */
+static const unsigned int OBJECT_CONSTANTS_PER_FRAME = 1024 * 1024;
+
+Renderer::Renderer()
+	: m_FrameConstants(sizeof(FrameConstants)), m_ObjectConstants(OBJECT_CONSTANTS_PER_FRAME) {
+	m_FrameConstants.BindBase(FRAME_CONSTANTS_BINDING);
+}
+
+void Renderer::BeginFrame(const FrameConstants& frame) {
+	m_FrameConstants.SetData(&frame, sizeof(FrameConstants));
+	m_FrameConstants.BindBase(FRAME_CONSTANTS_BINDING);
+	m_ObjectConstants.BeginFrame();
+}
+
+void Renderer::EndFrame() {
+	m_ObjectConstants.EndFrame();
+	DeletionQueue::EndFrame();
+}
+
+void Renderer::Shutdown() {
+	m_ObjectConstants.Shutdown();
+}
+
 void Renderer::Clear() const {
 	GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const {
 	shader.Bind();
+	DrawIndexed(va, ib);
+}
+
+void Renderer::DrawIndexed(const VertexArray& va, const IndexBuffer& ib) const {
 	va.Bind();
 	ib.Bind();
 
@@ -34,3 +72,55 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
 	*/
 	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
 }
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const ObjectConstants& object) {
+	shader.Bind();
+	BindObjectConstants(object);
+	DrawIndexed(va, ib);
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, Material& material, ResourceRegistry& resources,
+	const ObjectConstants& object) {
+	if (!material.Apply(resources)) {
+		return;
+	}
+	BindObjectConstants(object);
+	DrawIndexed(va, ib);
+}
+
+void Renderer::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const {
+	ASSERT(Shader::HasComputeShaders());
+	GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+void Renderer::Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const {
+	ASSERT(shader.IsCompute());
+	shader.Bind();
+	Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void Renderer::Barrier(unsigned int barriers) const {
+	ASSERT(Shader::HasComputeShaders());
+	GLCall(glMemoryBarrier(barriers));
+}
+
+void Renderer::StorageBarrier() const {
+	Barrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Renderer::VertexBarrier() const {
+	Barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+void Renderer::IndirectBarrier() const {
+	Barrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void Renderer::ReadbackBarrier() const {
+	Barrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void Renderer::BindObjectConstants(const ObjectConstants& object) {
+	unsigned int offset = m_ObjectConstants.Write(&object, sizeof(ObjectConstants));
+	m_ObjectConstants.BindRange(OBJECT_CONSTANTS_BINDING, offset, sizeof(ObjectConstants));
+}
@@ -3,8 +3,16 @@
 #include <GL/glew.h>
 #include <iostream>
 #include "VertexArray.h"
+#include "DeletionQueue.h"
 #include "IndexBuffer.h"
+#include "Material.h"
 #include "Shader.h"
+#include "ShaderStorageBuffer.h"
+#include "UniformBlocks.h"
+#include "UniformBuffer.h"
+#include "UniformRingBuffer.h"
+
+class ResourceRegistry;
 
 /* This is a Visual Studio specific break, there are more general ways to do this */
 #define ASSERT(x) if (!(x)) __debugbreak();
@@ -17,7 +25,46 @@ bool GLLogCall(const char* function, const char* file, int line);
 
 class Renderer {
 private:
+	UniformBuffer m_FrameConstants;
+	UniformRingBuffer m_ObjectConstants;
+
+	void BindObjectConstants(const ObjectConstants& object);
+	void DrawIndexed(const VertexArray& va, const IndexBuffer& ib) const;
 public:
+	Renderer();
+
+	/* Uploads the per-frame block once. Every program reads it through FRAME_CONSTANTS_BINDING */
+	void BeginFrame(const FrameConstants& frame);
+	/* Fences this frame's per-draw data so the ring doesn't overwrite it while the GPU reads it, and moves the
+	 * DeletionQueue along */
+	void EndFrame();
+	/* Releases what can't wait for the destructor, which makes no GL calls. Call before the context goes */
+	void Shutdown();
+
 	void Clear() const;
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	/* Per-object constants are copied into the ring and bound to OBJECT_CONSTANTS_BINDING for this draw only */
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const ObjectConstants& object);
+	/* Applies the material (binds its shader and uploads changed parameters) then draws.
+	 * Draws nothing if the material's shader has been destroyed */
+	void Draw(const VertexArray& va, const IndexBuffer& ib, Material& material, ResourceRegistry& resources,
+		const ObjectConstants& object);
+
+	/* Runs the bound compute program over groupsX * groupsY * groupsZ work groups (see Shader::GetWorkGroupSize) */
+	void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+	void Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+	/* Work groups needed to cover count items, groupSize at a time */
+	static inline unsigned int GroupCount(unsigned int count, unsigned int groupSize) { return (count + groupSize - 1) / groupSize; }
+
+	/* Compute writes aren't visible to later commands until a barrier covers the way they're read next.
+	 * Barrier takes GL_*_BARRIER_BIT flags, the rest are the common cases. */
+	void Barrier(unsigned int barriers) const;
+	/* Another dispatch or draw reads the storage buffer in a shader */
+	void StorageBarrier() const;
+	/* The buffer is drawn from as vertex or index data */
+	void VertexBarrier() const;
+	/* The buffer holds indirect draw/dispatch arguments */
+	void IndirectBarrier() const;
+	/* The CPU reads it back, or it's copied with glBufferSubData/glCopyBufferSubData */
+	void ReadbackBarrier() const;
 };
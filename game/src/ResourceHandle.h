@@ -0,0 +1,24 @@
+#pragma once
+
+/* 32 bits naming a resource in a ResourcePool<T>: the slot in the low INDEX_BITS, the slot's generation above.
+ * Destroying a resource bumps its slot's generation, so a handle kept past that no longer matches and is caught
+ * with one compare. Plain data, so anything holding handles stays trivially copyable. Value 0 is the null handle.
+ */
+template<typename T>
+struct ResourceHandle {
+	static const unsigned int INDEX_BITS = 20;
+	static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static const unsigned int MAX_GENERATION = 0xffffffffu >> INDEX_BITS;
+
+	unsigned int Value;
+
+	static inline ResourceHandle Make(unsigned int index, unsigned int generation) {
+		return { (generation << INDEX_BITS) | index };
+	}
+	inline unsigned int GetIndex() const { return Value & INDEX_MASK; }
+	inline unsigned int GetGeneration() const { return Value >> INDEX_BITS; }
+	inline bool IsNull() const { return Value == 0; }
+
+	inline bool operator==(const ResourceHandle& other) const { return Value == other.Value; }
+	inline bool operator!=(const ResourceHandle& other) const { return Value != other.Value; }
+};
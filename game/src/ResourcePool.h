@@ -0,0 +1,89 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "Renderer.h"
+#include "ResourceHandle.h"
+
+/* Owns every T it creates, packed into one vector so walking them all is a straight read. Handles go through
+ * a slot table to find their object: destroying one moves the last object into its place and repoints that
+ * object's slot, so the objects stay dense. T has to be movable (the GL wrappers are move-only).
+ * Pointers from Get() only last until the next Create or Destroy in the same pool, keep handles instead.
+ * A slot's generation wraps after MAX_GENERATION reuses, so a handle held that long could match again.
+ */
+template<typename T>
+class ResourcePool {
+public:
+	typedef ResourceHandle<T> Handle;
+	static const unsigned int NONE = 0xffffffff;
+
+private:
+	struct Slot {
+		unsigned int Dense;        /* Index into m_Objects, NONE while free */
+		unsigned int Generation;   /* Never 0, so no live handle is null */
+	};
+
+	std::vector<T> m_Objects;
+	/* Slot of each object, to fix up the slot of the object moved in by Destroy */
+	std::vector<unsigned int> m_Owners;
+	std::vector<Slot> m_Slots;
+	std::vector<unsigned int> m_FreeSlots;
+
+public:
+	template<typename... Args>
+	Handle Create(Args&&... args) {
+		unsigned int index;
+		if (!m_FreeSlots.empty()) {
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else {
+			index = (unsigned int)m_Slots.size();
+			ASSERT(index <= Handle::INDEX_MASK);
+			m_Slots.push_back({ NONE, 1 });
+		}
+		m_Objects.emplace_back(std::forward<Args>(args)...);
+		m_Owners.push_back(index);
+		m_Slots[index].Dense = (unsigned int)m_Objects.size() - 1;
+		return Handle::Make(index, m_Slots[index].Generation);
+	}
+
+	/* Does nothing for a stale or null handle */
+	void Destroy(Handle handle) {
+		if (!IsValid(handle)) {
+			return;
+		}
+		Slot& slot = m_Slots[handle.GetIndex()];
+		unsigned int last = (unsigned int)m_Objects.size() - 1;
+		if (slot.Dense != last) {
+			/* Move assigning releases the destroyed object's GL name */
+			m_Objects[slot.Dense] = std::move(m_Objects[last]);
+			m_Owners[slot.Dense] = m_Owners[last];
+			m_Slots[m_Owners[slot.Dense]].Dense = slot.Dense;
+		}
+		m_Objects.pop_back();
+		m_Owners.pop_back();
+
+		slot.Dense = NONE;
+		slot.Generation = slot.Generation == Handle::MAX_GENERATION ? 1 : slot.Generation + 1;
+		m_FreeSlots.push_back(handle.GetIndex());
+	}
+
+	inline bool IsValid(Handle handle) const {
+		unsigned int index = handle.GetIndex();
+		return index < m_Slots.size() && m_Slots[index].Generation == handle.GetGeneration() && m_Slots[index].Dense != NONE;
+	}
+	/* nullptr for a stale or null handle */
+	inline T* Get(Handle handle) {
+		return IsValid(handle) ? &m_Objects[m_Slots[handle.GetIndex()].Dense] : nullptr;
+	}
+	inline const T* Get(Handle handle) const {
+		return IsValid(handle) ? &m_Objects[m_Slots[handle.GetIndex()].Dense] : nullptr;
+	}
+
+	/* Every live object, in no particular order */
+	inline T* GetObjects() { return m_Objects.data(); }
+	inline const T* GetObjects() const { return m_Objects.data(); }
+	inline unsigned int GetCount() const { return (unsigned int)m_Objects.size(); }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "IndexBuffer.h"
+#include "Material.h"
+#include "ResourcePool.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+/* One place that owns the GL-backed resources, a dense ResourcePool per type. Everything else (components,
+ * draw lists, materials) holds ResourceHandles, which are 4 bytes, copy as plain data and can be checked for
+ * staleness, unlike a reference to an object that might already be gone.
+ * Destroying a resource hands its GL object to the DeletionQueue like any other wrapper going out of scope.
+ * Shaders are created here by ShaderLibrary, which still makes sure each program is only built once.
+ */
+class ResourceRegistry {
+private:
+	std::tuple<ResourcePool<VertexBuffer>, ResourcePool<IndexBuffer>, ResourcePool<VertexArray>, ResourcePool<Shader>,
+		ResourcePool<Material>> m_Pools;
+
+public:
+	template<typename T>
+	inline ResourcePool<T>& GetPool() { return std::get<ResourcePool<T>>(m_Pools); }
+	template<typename T>
+	inline const ResourcePool<T>& GetPool() const { return std::get<ResourcePool<T>>(m_Pools); }
+
+	/* args go to T's constructor */
+	template<typename T, typename... Args>
+	inline ResourceHandle<T> Create(Args&&... args) { return GetPool<T>().Create(std::forward<Args>(args)...); }
+	template<typename T>
+	inline void Destroy(ResourceHandle<T> handle) { GetPool<T>().Destroy(handle); }
+
+	template<typename T>
+	inline bool IsValid(ResourceHandle<T> handle) const { return GetPool<T>().IsValid(handle); }
+	/* nullptr for a stale or null handle. Only valid until the next Create or Destroy of a T */
+	template<typename T>
+	inline T* Get(ResourceHandle<T> handle) { return GetPool<T>().Get(handle); }
+	template<typename T>
+	inline const T* Get(ResourceHandle<T> handle) const { return GetPool<T>().Get(handle); }
+};
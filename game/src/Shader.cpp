@@ -1,60 +1,105 @@
 #include "Shader.h"
 
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <utility>
 
 #include "Renderer.h"
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+#include "UniformBlocks.h"
 
-Shader::Shader(const std::string& filepath)
-	: m_FilePath(filepath), m_RendererID(0) {
-	ShaderProgramSource source = ParseShader(filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+UniformStats Shader::s_UniformStats = { 0, 0 };
+bool Shader::s_DirectStateAccess = false;
+
+/* glProgramUniform* when we have it, so the program doesn't need binding. Otherwise the bound program's glUniform* */
+#define UNIFORM_CALL(function, location, ...) \
+	if (s_DirectStateAccess) { GLCall(glProgram##function(m_RendererID, location, __VA_ARGS__)); } \
+	else { GLCall(gl##function(location, __VA_ARGS__)); }
+
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines)
+	: m_FilePath(filepath), m_RendererID(0), m_WorkGroupSize({ 0, 0, 0 }), m_Linked(false) {
+	s_DirectStateAccess = GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+	ShaderProgramSource source = ParseShader(filepath, defines);
+	m_RendererID = CreateShader(source);
 }
 
-Shader::~Shader() {
-	GLCall(glDeleteProgram(m_RendererID));
+Shader::Shader(const std::string& name, const ShaderStageIDs& stages, ShaderUniformLocationView locations)
+	: m_FilePath(name), m_RendererID(0), m_WorkGroupSize({ 0, 0, 0 }), m_Linked(false) {
+	s_DirectStateAccess = GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+	m_RendererID = LinkProgram(stages, locations);
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
-	std::ifstream stream(filePath);
+Shader::Shader(const std::string& name, unsigned int program, ShaderUniformLocationView locations)
+	: m_FilePath(name), m_RendererID(program), m_WorkGroupSize({ 0, 0, 0 }), m_Linked(false) {
+	s_DirectStateAccess = GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+	FinishLink(program, locations);
+}
 
-	enum class ShaderType {
-		NONE = -1, VEXTEX = 0, FRAGMENT = 1
-	};
+Shader::~Shader() {
+	Release();
+}
 
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
-	while (getline(stream, line)) {
-		if (line.find("#shader") != std::string::npos) {
-			if (line.find("vertex") != std::string::npos) {
-				type = ShaderType::VEXTEX;
-			}
-			else if (line.find("fragment") != std::string::npos) {
-				type = ShaderType::FRAGMENT;
-			}
-		}
-		else {
-			ss[(int)type] << line << '\n';
-		}
+Shader::Shader(Shader&& other) noexcept
+	: m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+	m_UniformSlots(std::move(other.m_UniformSlots)), m_UniformShadow(std::move(other.m_UniformShadow)),
+	m_Reflection(std::move(other.m_Reflection)), m_WorkGroupSize(other.m_WorkGroupSize), m_Linked(other.m_Linked) {
+	other.m_RendererID = 0;
+	other.m_WorkGroupSize = { 0, 0, 0 };
+	other.m_Linked = false;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+	if (this != &other) {
+		Release();
+		m_FilePath = std::move(other.m_FilePath);
+		m_RendererID = other.m_RendererID;
+		m_UniformSlots = std::move(other.m_UniformSlots);
+		m_UniformShadow = std::move(other.m_UniformShadow);
+		m_Reflection = std::move(other.m_Reflection);
+		m_WorkGroupSize = other.m_WorkGroupSize;
+		m_Linked = other.m_Linked;
+		other.m_RendererID = 0;
+		other.m_WorkGroupSize = { 0, 0, 0 };
+		other.m_Linked = false;
 	}
-	return { ss[0].str(), ss[1].str() };
+	return *this;
+}
+
+void Shader::Release() {
+	DeletionQueue::Enqueue(PROGRAM_OBJECT, m_RendererID);
+	m_RendererID = 0;
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filePath, const ShaderDefines& defines) {
+	ShaderPreprocessor preprocessor(defines);
+	return preprocessor.Process(filePath);
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source) {
+unsigned int Shader::CompileShader(unsigned int type, std::string_view source) {
+	unsigned int id = BeginCompile(type, source);
+	return CheckCompile(id, type) ? id : 0;
+}
+
+/* Doesn't wait for the result, so the driver can work on several stages at once */
+unsigned int Shader::BeginCompile(unsigned int type, std::string_view source) {
 	GLCall(unsigned int id = glCreateShader(type));
-	const char* src = source.c_str();
+	const char* src = source.data();
+	int length = (int)source.size();
 
 	/* id : the shader we created earlier
 	* 1: how many source codes
 	* &src : the source code
-	* nullptr : length, think this is the array of the lengths of each source code
+	* &length : array of the lengths of each source code. The source doesn't need to be null terminated
 	*/
-	GLCall(glShaderSource(id, 1, &src, nullptr));
+	GLCall(glShaderSource(id, 1, &src, &length));
 	GLCall(glCompileShader(id));
+	return id;
+}
 
+/* Deletes the shader object if it failed */
+bool Shader::CheckCompile(unsigned int id, unsigned int type) {
 	/* Error handling */
 	int result;
 	GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
@@ -71,31 +116,157 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 		* and a buffer to write message to
 		*/
 		GLCall(glGetShaderInfoLog(id, length, &length, message));
-		std::cout << "Failed to compile " <<
-			(type == GL_VERTEX_SHADER ? "vertex" : "fragment")
-			<< " shader!" << std::endl;
+		const char* stageName = "unknown";
+		for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+			if (GetGLStageType((ShaderStage)i) == type) {
+				stageName = ShaderParser::GetStageName((ShaderStage)i);
+			}
+		}
+		std::cout << "Failed to compile " << stageName << " shader!" << std::endl;
 		std::cout << message << std::endl;
 		GLCall(glDeleteShader(id));
-		return 0;
+		return false;
 	}
-	return id;
+	return true;
 }
 
 /* For simplicity, shader source code will be a string in our code */
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
+/* Compiles whichever stages the file has */
+unsigned int Shader::CreateShader(const ShaderProgramSource& source) {
+	ShaderStageIDs stages = {};
+	for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+		if (!source.Sources[i].empty()) {
+			stages[i] = CompileShader(GetGLStageType((ShaderStage)i), source.Sources[i]);
+		}
+	}
+
+	unsigned int program = LinkProgram(stages, source.UniformLocations);
+
+	for (unsigned int stage : stages) {
+		if (stage) {
+			GLCall(glDeleteShader(stage));
+		}
+	}
+
+	return program;
+}
+
+unsigned int Shader::LinkProgram(const ShaderStageIDs& stages, ShaderUniformLocationView locations) {
+	unsigned int program = BeginLink(stages);
+	FinishLink(program, locations);
+	return program;
+}
+
+/* Like BeginCompile, doesn't wait for the link to finish */
+unsigned int Shader::BeginLink(const ShaderStageIDs& stages) {
 	GLCall(unsigned int program = glCreateProgram());
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
-	GLCall(glAttachShader(program, vs));
-	GLCall(glAttachShader(program, fs));
+	for (unsigned int stage : stages) {
+		if (stage) {
+			GLCall(glAttachShader(program, stage));
+		}
+	}
 	GLCall(glLinkProgram(program));
+	return program;
+}
+
+unsigned int Shader::GetGLStageType(ShaderStage stage) {
+	switch (stage) {
+		case VERTEX_STAGE: return GL_VERTEX_SHADER;
+		case TESS_CONTROL_STAGE: return GL_TESS_CONTROL_SHADER;
+		case TESS_EVALUATION_STAGE: return GL_TESS_EVALUATION_SHADER;
+		case GEOMETRY_STAGE: return GL_GEOMETRY_SHADER;
+		case FRAGMENT_STAGE: return GL_FRAGMENT_SHADER;
+		case COMPUTE_STAGE: return GL_COMPUTE_SHADER;
+		case SHADER_STAGE_COUNT: break;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+/* Stages are detached once linked, so whoever compiled them decides when they're deleted */
+void Shader::FinishLink(unsigned int program, ShaderUniformLocationView locations) {
+	int result;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+	if (result == GL_FALSE) {
+		int length;
+		GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+		std::vector<char> message(length > 0 ? length : 1);
+		GLCall(glGetProgramInfoLog(program, length, &length, message.data()));
+		std::cout << "Failed to link '" << m_FilePath << "'!" << std::endl;
+		std::cout << message.data() << std::endl;
+	}
+	m_Linked = result == GL_TRUE;
 	GLCall(glValidateProgram(program));
 
-	GLCall(glDeleteShader(vs));
-	GLCall(glDeleteShader(fs));
+	unsigned int stages[SHADER_STAGE_COUNT];
+	int count = 0;
+	GLCall(glGetAttachedShaders(program, SHADER_STAGE_COUNT, &count, stages));
+	for (int i = 0; i < count; i++) {
+		int type;
+		GLCall(glGetShaderiv(stages[i], GL_SHADER_TYPE, &type));
+		if (type == GL_COMPUTE_SHADER && result == GL_TRUE) {
+			GLCall(glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, m_WorkGroupSize.data()));
+		}
+		GLCall(glDetachShader(program, stages[i]));
+	}
 
-	return program;
+	Reflect(program, locations);
+}
+
+/* Enumerate everything up front so the first frame doesn't stall on glGetUniformLocation */
+void Shader::Reflect(unsigned int program, ShaderUniformLocationView locations) {
+	m_Reflection = ShaderReflection::Reflect(program, locations);
+
+	m_UniformSlots.assign(UniformID::GetCount(), { UNRESOLVED_LOCATION, 0, 0, false });
+	m_UniformShadow.clear();
+	for (const ShaderUniformInfo& info : m_Reflection.Uniforms) {
+		if (info.BlockIndex == -1) {
+			unsigned int size = ShaderReflection::GetSizeOfType(info.Type) * info.Size;
+			m_UniformSlots[info.ID.GetIndex()] = { info.Location, (unsigned int)m_UniformShadow.size(), size, false };
+			m_UniformShadow.resize(m_UniformShadow.size() + size);
+		}
+	}
+
+	BindUniformBlocks(program);
+}
+
+/* Points each block at its shared binding, so one buffer bind serves every program */
+void Shader::BindUniformBlocks(unsigned int program) {
+	for (ShaderUniformBlockInfo& block : m_Reflection.UniformBlocks) {
+		const UniformBlockDescription* description = nullptr;
+		for (const UniformBlockDescription& known : s_UniformBlocks) {
+			if (block.Name == known.Name) {
+				description = &known;
+			}
+		}
+		if (!description) {
+			std::cout << "Warning: uniform block '" << block.Name << "' in '" << m_FilePath
+				<< "' has no binding point" << std::endl;
+			continue;
+		}
+		if (description->Size != 0 && (unsigned int)block.DataSize != description->Size) {
+			std::cout << "Warning: uniform block '" << block.Name << "' in '" << m_FilePath << "' is "
+				<< block.DataSize << " bytes, C++ expects " << description->Size << std::endl;
+		}
+
+		GLCall(glUniformBlockBinding(program, block.Index, description->Binding));
+		block.Binding = description->Binding;
+	}
+}
+
+void Shader::SetStorageBlockBinding(const std::string& name, unsigned int binding) {
+	ASSERT(HasComputeShaders());
+	GLCall(unsigned int index = glGetProgramResourceIndex(m_RendererID, GL_SHADER_STORAGE_BLOCK, name.c_str()));
+	if (index == GL_INVALID_INDEX) {
+		std::cout << "Warning: storage block '" << name << "' doesn't exist in '" << m_FilePath << "'" << std::endl;
+		return;
+	}
+	GLCall(glShaderStorageBlockBinding(m_RendererID, index, binding));
+}
+
+bool Shader::HasComputeShaders() {
+	return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
 }
 
 void Shader::Bind() const {
@@ -106,19 +277,159 @@ void Shader::Unbind() const {
 	GLCall(glUseProgram(0));
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3) {
-	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+void Shader::SetUniform1i(UniformID uniform, int value) {
+	int location = PrepareUniform(uniform, GL_INT, &value, sizeof(value));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform1i, location, value);
+	}
+}
+
+void Shader::SetUniform1f(UniformID uniform, float value) {
+	int location = PrepareUniform(uniform, GL_FLOAT, &value, sizeof(value));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform1f, location, value);
+	}
 }
 
-int Shader::GetUniformLocation(const std::string& name) {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end()) {
-		return m_UniformLocationCache[name];
+void Shader::SetUniform2f(UniformID uniform, float v0, float v1) {
+	const float value[] = { v0, v1 };
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC2, value, sizeof(value));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform2f, location, v0, v1);
 	}
+}
+
+void Shader::SetUniform3f(UniformID uniform, float v0, float v1, float v2) {
+	const float value[] = { v0, v1, v2 };
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC3, value, sizeof(value));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform3f, location, v0, v1, v2);
+	}
+}
+
+void Shader::SetUniform4f(UniformID uniform, float v0, float v1, float v2, float v3) {
+	const float value[] = { v0, v1, v2, v3 };
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC4, value, sizeof(value));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform4f, location, v0, v1, v2, v3);
+	}
+}
+
+void Shader::SetUniformMat3f(UniformID uniform, const float* matrix) {
+	int location = PrepareUniform(uniform, GL_FLOAT_MAT3, matrix, 9 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(UniformMatrix3fv, location, 1, GL_FALSE, matrix);
+	}
+}
+
+void Shader::SetUniformMat4f(UniformID uniform, const float* matrix) {
+	int location = PrepareUniform(uniform, GL_FLOAT_MAT4, matrix, 16 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(UniformMatrix4fv, location, 1, GL_FALSE, matrix);
+	}
+}
+
+void Shader::SetUniform1iv(UniformID uniform, unsigned int count, const int* values) {
+	int location = PrepareUniform(uniform, GL_INT, values, count * sizeof(int));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform1iv, location, count, values);
+	}
+}
+
+void Shader::SetUniform1fv(UniformID uniform, unsigned int count, const float* values) {
+	int location = PrepareUniform(uniform, GL_FLOAT, values, count * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform1fv, location, count, values);
+	}
+}
 
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1) {
-		std::cout << "Warning: uniform '" << name << "' doesn't exist" << std::endl;
+void Shader::SetUniform2fv(UniformID uniform, unsigned int count, const float* values) {
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC2, values, count * 2 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform2fv, location, count, values);
 	}
-	m_UniformLocationCache[name] = location;
-	return location;
-}
\ No newline at end of file
+}
+
+void Shader::SetUniform3fv(UniformID uniform, unsigned int count, const float* values) {
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC3, values, count * 3 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform3fv, location, count, values);
+	}
+}
+
+void Shader::SetUniform4fv(UniformID uniform, unsigned int count, const float* values) {
+	int location = PrepareUniform(uniform, GL_FLOAT_VEC4, values, count * 4 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(Uniform4fv, location, count, values);
+	}
+}
+
+void Shader::SetUniformMat3fv(UniformID uniform, unsigned int count, const float* matrices) {
+	int location = PrepareUniform(uniform, GL_FLOAT_MAT3, matrices, count * 9 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(UniformMatrix3fv, location, count, GL_FALSE, matrices);
+	}
+}
+
+void Shader::SetUniformMat4fv(UniformID uniform, unsigned int count, const float* matrices) {
+	int location = PrepareUniform(uniform, GL_FLOAT_MAT4, matrices, count * 16 * sizeof(float));
+	if (location != -1) {
+		UNIFORM_CALL(UniformMatrix4fv, location, count, GL_FALSE, matrices);
+	}
+}
+
+int Shader::PrepareUniform(UniformID uniform, unsigned int type, const void* data, unsigned int size) {
+	ValidateUniform(uniform, type);
+	UniformSlot& slot = GetUniformSlot(uniform);
+	return UpdateShadow(slot, data, size) ? slot.Location : -1;
+}
+
+bool Shader::UpdateShadow(UniformSlot& slot, const void* data, unsigned int size) {
+	if (slot.Location == -1) {
+		return false;
+	}
+
+	/* Arrays may be uploaded partially, only the bytes sent are compared */
+	ASSERT(size <= slot.ShadowSize);
+	unsigned char* shadow = m_UniformShadow.data() + slot.ShadowOffset;
+	if (slot.HasValue && memcmp(shadow, data, size) == 0) {
+		s_UniformStats.Skipped++;
+		return false;
+	}
+
+	memcpy(shadow, data, size);
+	slot.HasValue = true;
+	s_UniformStats.Issued++;
+	return true;
+}
+
+void Shader::ResetUniformStats() {
+	s_UniformStats = { 0, 0 };
+}
+
+/* Cold path, only hit for a name the program didn't report at link time. Warns once per name */
+Shader::UniformSlot& Shader::ResolveUniformSlot(UniformID uniform) {
+	if (uniform.GetIndex() >= m_UniformSlots.size()) {
+		m_UniformSlots.resize(UniformID::GetCount(), { UNRESOLVED_LOCATION, 0, 0, false });
+	}
+
+	std::cout << "Warning: uniform '" << uniform.GetName() << "' doesn't exist" << std::endl;
+	UniformSlot& slot = m_UniformSlots[uniform.GetIndex()];
+	slot.Location = -1;
+	return slot;
+}
+
+/* Catches setting a uniform with the wrong setter, which GL otherwise reports as a bare GL_INVALID_OPERATION */
+void Shader::ValidateUniform(UniformID uniform, unsigned int type) const {
+#ifdef _DEBUG
+	const ShaderUniformInfo* info = m_Reflection.FindUniform(uniform);
+	/* Samplers, images and bools are set through the int setters */
+	bool intLike = type == GL_INT && info && (info->Type == GL_BOOL || ShaderReflection::IsSamplerType(info->Type) ||
+		ShaderReflection::IsImageType(info->Type));
+	if (info && info->Type != type && !intLike) {
+		std::cout << "Warning: uniform '" << uniform.GetName() << "' in '" << m_FilePath
+			<< "' set with the wrong type" << std::endl;
+		ASSERT(false);
+	}
+#endif
+}
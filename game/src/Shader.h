@@ -1,30 +1,160 @@
 #pragma once
+#include <array>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+
+#include "ShaderReflection.h"
+#include "UniformID.h"
+
+/* Pipeline order. Compute programs have the compute stage only */
+enum ShaderStage : unsigned int {
+	VERTEX_STAGE = 0,
+	TESS_CONTROL_STAGE,
+	TESS_EVALUATION_STAGE,
+	GEOMETRY_STAGE,
+	FRAGMENT_STAGE,
+	COMPUTE_STAGE,
+	SHADER_STAGE_COUNT
+};
 
 struct ShaderProgramSource {
-	std::string VertexSource;
-	std::string FragmentSource;
+	/* Indexed by ShaderStage, empty for stages the file doesn't have */
+	std::string Sources[SHADER_STAGE_COUNT];
+	/* Every layout(location = N) uniform in any stage */
+	ShaderUniformLocations UniformLocations;
+};
+
+/* Compiled stage objects indexed by ShaderStage, 0 for stages not in the program */
+typedef std::array<unsigned int, SHADER_STAGE_COUNT> ShaderStageIDs;
+
+/* How many glUniform* calls the shadow copies let through vs. dropped, across all programs */
+struct UniformStats {
+	unsigned long long Issued;
+	unsigned long long Skipped;
 };
 
+/* Lines injected as #define after #version, eg. { "SKINNING", "FOG_DENSITY 0.02" } */
+typedef std::vector<std::string> ShaderDefines;
+
 class Shader {
 private:
+	static const int UNRESOLVED_LOCATION = -2;
+
 	std::string m_FilePath;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	/* Where a uniform lives, and where its last uploaded value is kept in m_UniformShadow */
+	struct UniformSlot {
+		int Location;
+		unsigned int ShadowOffset;
+		unsigned int ShadowSize;
+		bool HasValue;
+	};
+
+	/* Indexed by UniformID and filled from reflection at link time.
+	 * Location is UNRESOLVED only for names interned after the link, -1 if the program doesn't have it */
+	std::vector<UniformSlot> m_UniformSlots;
+	/* Uniform values are per program state, so a copy of the last bytes sent is exact */
+	std::vector<unsigned char> m_UniformShadow;
+	ShaderReflection m_Reflection;
+	/* local_size_x/y/z of a compute program, all 0 for anything else */
+	std::array<int, 3> m_WorkGroupSize;
+	bool m_Linked;
+
+	static UniformStats s_UniformStats;
+	/* glProgramUniform* (GL 4.1 / ARB_separate_shader_objects) lets uniforms be set without binding the program */
+	static bool s_DirectStateAccess;
+
+	ShaderProgramSource ParseShader(const std::string& filePath, const ShaderDefines& defines);
+	unsigned int CreateShader(const ShaderProgramSource& source);
+	/* locations are declared in the source, so reflection doesn't have to look those up */
+	unsigned int LinkProgram(const ShaderStageIDs& stages, ShaderUniformLocationView locations);
+	void FinishLink(unsigned int program, ShaderUniformLocationView locations);
+	void Reflect(unsigned int program, ShaderUniformLocationView locations);
+	void BindUniformBlocks(unsigned int program);
+	UniformSlot& ResolveUniformSlot(UniformID uniform);
+	void ValidateUniform(UniformID uniform, unsigned int type) const;
 
-	ShaderProgramSource ParseShader(const std::string& filePath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
+	inline UniformSlot& GetUniformSlot(UniformID uniform) {
+		unsigned int index = uniform.GetIndex();
+		if (index < m_UniformSlots.size() && m_UniformSlots[index].Location != UNRESOLVED_LOCATION) {
+			return m_UniformSlots[index];
+		}
+		return ResolveUniformSlot(uniform);
+	}
+
+	/* False when the program already holds these bytes (or doesn't have the uniform), so the GL call can be skipped */
+	bool UpdateShadow(UniformSlot& slot, const void* data, unsigned int size);
+	/* Validates and shadows a write. Returns the location to upload to, or -1 when there's nothing to do */
+	int PrepareUniform(UniformID uniform, unsigned int type, const void* data, unsigned int size);
+
+	void Release();
 
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, const ShaderDefines& defines = {});
+	/* Links stages compiled with CompileShader. The caller keeps ownership of them (see ShaderLibrary).
+	 * locations are the explicit uniform locations from the stages' source (ShaderProgramSource::UniformLocations or
+	 * a built in shader's table), only read during the constructor */
+	Shader(const std::string& name, const ShaderStageIDs& stages, ShaderUniformLocationView locations = {});
+	/* Takes ownership of a program started with BeginLink, waiting for the link if it's still running */
+	Shader(const std::string& name, unsigned int program, ShaderUniformLocationView locations = {});
 	~Shader();
+	/* Move-only, the program has one owner. A moved-from shader has program 0 and no uniforms */
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
+	/* Returns the shader object id, or 0 if it failed to compile */
+	static unsigned int CompileShader(unsigned int type, std::string_view source);
+	/* Split versions for batches: start every compile/link first, then check them, so nothing waits on the
+	 * driver until it has the whole batch */
+	static unsigned int BeginCompile(unsigned int type, std::string_view source);
+	static bool CheckCompile(unsigned int id, unsigned int type);
+	static unsigned int BeginLink(const ShaderStageIDs& stages);
+
+	/* GL_VERTEX_SHADER etc */
+	static unsigned int GetGLStageType(ShaderStage stage);
 
 	void Bind() const;
 	void Unbind() const;
 
-	/* Set uniforms. 4f because we're passing 4 floats (to a vec4) */
-	void SetUniform4f(const std::string& name, float v0, float V1, float v2, float v3);
-};
\ No newline at end of file
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	/* False if the link failed (the log has been printed). The program still exists but draws nothing useful */
+	inline bool IsLinked() const { return m_Linked; }
+	inline const ShaderReflection& GetReflection() const { return m_Reflection; }
+
+	inline bool IsCompute() const { return m_WorkGroupSize[0] != 0; }
+	inline const std::array<int, 3>& GetWorkGroupSize() const { return m_WorkGroupSize; }
+
+	/* Points a buffer block at a storage binding. Only needed when the GLSL doesn't say layout(binding = N) */
+	void SetStorageBlockBinding(const std::string& name, unsigned int binding);
+
+	static inline const UniformStats& GetUniformStats() { return s_UniformStats; }
+	static void ResetUniformStats();
+
+	/* Set uniforms. 4f because we're passing 4 floats (to a vec4), Mat4f for a mat4 and so on.
+	 * With direct state access these don't need the program bound, otherwise Bind() first.
+	 * Matrices are column major.
+	 */
+	void SetUniform1i(UniformID uniform, int value);
+	void SetUniform1f(UniformID uniform, float value);
+	void SetUniform2f(UniformID uniform, float v0, float v1);
+	void SetUniform3f(UniformID uniform, float v0, float v1, float v2);
+	void SetUniform4f(UniformID uniform, float v0, float V1, float v2, float v3);
+	void SetUniformMat3f(UniformID uniform, const float* matrix);
+	void SetUniformMat4f(UniformID uniform, const float* matrix);
+
+	/* Arrays, count elements starting at element 0. Mat4fv uploads a whole bone/transform palette in one call */
+	void SetUniform1iv(UniformID uniform, unsigned int count, const int* values);
+	void SetUniform1fv(UniformID uniform, unsigned int count, const float* values);
+	void SetUniform2fv(UniformID uniform, unsigned int count, const float* values);
+	void SetUniform3fv(UniformID uniform, unsigned int count, const float* values);
+	void SetUniform4fv(UniformID uniform, unsigned int count, const float* values);
+	void SetUniformMat3fv(UniformID uniform, unsigned int count, const float* matrices);
+	void SetUniformMat4fv(UniformID uniform, unsigned int count, const float* matrices);
+
+	static inline bool HasDirectStateAccess() { return s_DirectStateAccess; }
+	/* Compute programs and storage buffers need GL 4.3, or ARB_compute_shader and ARB_shader_storage_buffer_object */
+	static bool HasComputeShaders();
+};
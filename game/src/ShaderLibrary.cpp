@@ -0,0 +1,278 @@
+#include "ShaderLibrary.h"
+#include "EmbeddedShader.h"
+#include "Renderer.h"
+#include "ResourceRegistry.h"
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <set>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/* A stage with source but no id failed to compile (or isn't supported), linking without it would quietly
+ * give a program missing that stage */
+static bool HasEveryStage(const ShaderStageIDs& stages, const std::string_view* sources) {
+	for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+		if (!sources[i].empty() && stages[i] == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static double MillisecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template<typename Programs>
+static void ReportPreWarm(const Programs& pending, Clock::time_point start, unsigned int threadCount) {
+	std::cout << "Pre-warmed " << pending.size() << " shader programs in " << MillisecondsSince(start)
+		<< "ms on " << threadCount << " threads" << std::endl;
+	for (const auto& program : pending) {
+		std::cout << "  " << program.Path << " (" << program.Defines.size() << " defines): preprocess "
+			<< program.PreprocessTime << "ms, link wait " << program.LinkTime << "ms" << std::endl;
+	}
+}
+
+ShaderLibrary::ShaderLibrary(ResourceRegistry& resources)
+	: m_Resources(resources), m_Jobs(nullptr) {
+}
+
+ShaderLibrary::~ShaderLibrary() {
+	Clear();
+}
+
+ResourceHandle<Shader> ShaderLibrary::Get(const std::string& filepath, const ShaderDefines& defines) {
+	auto variantKey = std::make_pair(filepath, ShaderPreprocessor::JoinDefines(defines));
+	auto variant = m_Variants.find(variantKey);
+	if (variant != m_Variants.end()) {
+		return variant->second;
+	}
+
+	/* Defines have to be injected into the text, so only the plain variant comes straight from the executable */
+	const EmbeddedShader* embedded = defines.empty() ? FindEmbeddedShader(filepath) : nullptr;
+	ShaderStageIDs stages = {};
+	std::string_view sources[SHADER_STAGE_COUNT];
+	ShaderProgramSource source;
+	ShaderUniformLocationView locations;
+	if (embedded) {
+		std::copy(std::begin(embedded->Sources), std::end(embedded->Sources), sources);
+		locations = GetEmbeddedUniformLocations(*embedded);
+	}
+	else {
+		ShaderPreprocessor preprocessor(defines);
+		source = preprocessor.Process(filepath);
+		std::copy(std::begin(source.Sources), std::end(source.Sources), sources);
+		locations = source.UniformLocations;
+	}
+	for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+		stages[i] = GetStage((ShaderStage)i, sources[i], embedded != nullptr);
+	}
+	if (!HasEveryStage(stages, sources)) {
+		return {};
+	}
+
+	ResourceHandle<Shader> shader = GetProgram(filepath, stages, locations);
+	if (!shader.IsNull()) {
+		m_Variants.emplace(variantKey, shader);
+	}
+	return shader;
+}
+
+ResourceHandle<Shader> ShaderLibrary::GetProgram(const std::string& name, const ShaderStageIDs& stages, ShaderUniformLocationView locations) {
+	auto program = m_Programs.find(stages);
+	if (program != m_Programs.end()) {
+		return program->second;
+	}
+
+	ResourceHandle<Shader> shader = m_Resources.Create<Shader>(name, stages, locations);
+	if (!m_Resources.Get(shader)->IsLinked()) {
+		m_Resources.Destroy(shader);
+		return {};
+	}
+	m_Programs.emplace(stages, shader);
+	return shader;
+}
+
+void ShaderLibrary::PreWarm(const std::string& directory, const std::vector<ShaderDefines>& variants) {
+	Clock::time_point start = Clock::now();
+
+	/* Only whole programs, include files (.glsl) get pulled in by them */
+	std::vector<PendingProgram> pending;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".shader") {
+			std::string path = entry.path().generic_string();
+			for (const ShaderDefines& defines : variants) {
+				if (m_Variants.find(std::make_pair(path, ShaderPreprocessor::JoinDefines(defines))) == m_Variants.end()) {
+					pending.push_back({ path, defines, {}, {}, {}, false, 0.0, 0.0, {}, 0 });
+				}
+			}
+		}
+	}
+
+	/* File I/O and preprocessing don't touch GL, so they can go wide */
+	auto preprocess = [&pending](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			Clock::time_point programStart = Clock::now();
+			ShaderPreprocessor preprocessor(pending[i].Defines);
+			pending[i].Source = preprocessor.Process(pending[i].Path);
+			for (unsigned int stage = 0; stage < SHADER_STAGE_COUNT; stage++) {
+				pending[i].Stages[stage] = pending[i].Source.Sources[stage];
+			}
+			/* pending doesn't grow from here on, so the view stays put */
+			pending[i].Locations = pending[i].Source.UniformLocations;
+			pending[i].PreprocessTime = MillisecondsSince(programStart);
+		}
+	};
+	unsigned int threadCount = 1;
+	if (m_Jobs) {
+		m_Jobs->ParallelFor(0, (unsigned int)pending.size(), 1, preprocess);
+		threadCount = std::min(m_Jobs->GetWorkerCount(), std::max(1u, (unsigned int)pending.size()));
+	}
+	else {
+		preprocess(0, (unsigned int)pending.size());
+	}
+
+	BuildBatch(pending);
+	ReportPreWarm(pending, start, threadCount);
+}
+
+void ShaderLibrary::PreWarmEmbedded() {
+	Clock::time_point start = Clock::now();
+
+	std::vector<PendingProgram> pending;
+	for (const EmbeddedShader& embedded : GetEmbeddedShaders()) {
+		std::string path(embedded.Path);
+		if (m_Variants.find(std::make_pair(path, ShaderPreprocessor::JoinDefines({}))) == m_Variants.end()) {
+			pending.push_back({ path, {}, {}, {}, GetEmbeddedUniformLocations(embedded), true, 0.0, 0.0, {}, 0 });
+			std::copy(std::begin(embedded.Sources), std::end(embedded.Sources), pending.back().Stages);
+		}
+	}
+
+	BuildBatch(pending);
+	ReportPreWarm(pending, start, 1);
+}
+
+void ShaderLibrary::BuildBatch(std::vector<PendingProgram>& pending) {
+	/* Let the driver use its own compiler threads where it can */
+	if (GLEW_KHR_parallel_shader_compile) {
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+	}
+
+	/* Issue every compile... */
+	std::vector<unsigned int> compiling;
+	for (PendingProgram& program : pending) {
+		for (unsigned int stage = 0; stage < SHADER_STAGE_COUNT; stage++) {
+			program.StageIDs[stage] = GetStage((ShaderStage)stage, program.Stages[stage], program.Embedded, &compiling);
+		}
+	}
+	/* ...and every link, before asking for any result */
+	std::set<ShaderStageIDs> linking;
+	for (PendingProgram& program : pending) {
+		if (HasEveryStage(program.StageIDs, program.Stages) && m_Programs.find(program.StageIDs) == m_Programs.end() &&
+			linking.insert(program.StageIDs).second) {
+			program.Program = Shader::BeginLink(program.StageIDs);
+		}
+	}
+
+	std::set<unsigned int> failed;
+	for (unsigned int id : compiling) {
+		GLint type;
+		GLCall(glGetShaderiv(id, GL_SHADER_TYPE, &type));
+		if (!Shader::CheckCompile(id, type)) {
+			/* CheckCompile deleted it, forget it so the next request compiles it again */
+			failed.insert(id);
+			for (auto& stages : m_Stages) {
+				for (auto stage = stages.begin(); stage != stages.end();) {
+					stage = stage->second == id ? stages.erase(stage) : std::next(stage);
+				}
+			}
+			/* After the key viewing it has gone */
+			m_StageSources.erase(id);
+		}
+	}
+
+	for (PendingProgram& program : pending) {
+		Clock::time_point linkStart = Clock::now();
+		bool compiled = HasEveryStage(program.StageIDs, program.Stages) &&
+			std::none_of(program.StageIDs.begin(), program.StageIDs.end(), [&failed](unsigned int id) { return failed.count(id) != 0; });
+		if (program.Program && compiled) {
+			ResourceHandle<Shader> shader = m_Resources.Create<Shader>(program.Path, program.Program, program.Locations);
+			if (m_Resources.Get(shader)->IsLinked()) {
+				m_Programs.emplace(program.StageIDs, shader);
+			}
+			else {
+				m_Resources.Destroy(shader);
+			}
+		}
+		else if (program.Program) {
+			/* Linked against a stage that didn't compile, it can't be any use */
+			DeletionQueue::Enqueue(PROGRAM_OBJECT, program.Program);
+		}
+		/* Programs sharing stages with one linked above only find it here */
+		auto linked = m_Programs.find(program.StageIDs);
+		if (compiled && linked != m_Programs.end()) {
+			m_Variants.emplace(std::make_pair(program.Path, ShaderPreprocessor::JoinDefines(program.Defines)), linked->second);
+		}
+		program.LinkTime = MillisecondsSince(linkStart);
+	}
+}
+
+unsigned int ShaderLibrary::GetStage(ShaderStage stage, std::string_view source, bool embedded, std::vector<unsigned int>* pending) {
+	if (source.empty()) {
+		return 0;
+	}
+
+	if (stage == COMPUTE_STAGE && !Shader::HasComputeShaders()) {
+		std::cout << "Warning: compute shaders need GL 4.3, skipping a compute stage" << std::endl;
+		return 0;
+	}
+
+	auto it = m_Stages[stage].find(source);
+	if (it != m_Stages[stage].end()) {
+		return it->second;
+	}
+
+	unsigned int type = Shader::GetGLStageType(stage);
+	unsigned int id;
+	if (pending) {
+		id = Shader::BeginCompile(type, source);
+	}
+	else {
+		id = Shader::CompileShader(type, source);
+	}
+	if (id == 0) {
+		return 0;
+	}
+	if (pending) {
+		pending->push_back(id);
+	}
+
+	if (!embedded) {
+		source = m_StageSources.emplace(id, std::string(source)).first->second;
+	}
+	m_Stages[stage].emplace(source, id);
+	return id;
+}
+
+void ShaderLibrary::Clear() {
+	/* Variants only ever point at these */
+	for (auto& program : m_Programs) {
+		m_Resources.Destroy(program.second);
+	}
+	m_Variants.clear();
+	m_Programs.clear();
+
+	for (auto& stages : m_Stages) {
+		for (auto& stage : stages) {
+			DeletionQueue::Enqueue(SHADER_OBJECT, stage.second);
+		}
+		stages.clear();
+	}
+	m_StageSources.clear();
+}
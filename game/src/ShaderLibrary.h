@@ -0,0 +1,92 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+#include "ResourceHandle.h"
+#include "Shader.h"
+
+class ResourceRegistry;
+
+/* Builds programs into a ResourceRegistry and hands out their handles, so nothing is compiled or linked twice.
+ * - By path: a (file, define set) pair is preprocessed once, later requests are a map lookup
+ * - By content: stage objects are interned by their preprocessed source, so programs that share a stage share the
+ *   compiled object. Two variants that preprocess to the same set of stages (a define
+ *   neither stage uses, say) get the same program
+ * - Built in: shaders embedded by shadertool (see EmbeddedShader.h) are used straight from the executable
+ * Nothing that failed to compile or link is cached, so fixing the file and asking again rebuilds it.
+ * Stage objects go to the DeletionQueue when they're dropped, so Clear() makes no GL calls and is safe mid-frame
+ * or from the destructor. The registry has to outlive the library.
+ */
+class ShaderLibrary {
+private:
+	/* (file, ShaderPreprocessor::JoinDefines) */
+	std::map<std::pair<std::string, std::string>, ResourceHandle<Shader>> m_Variants;
+	/* Keyed by the stage object ids, which are themselves unique per source. Every program the library created */
+	std::map<ShaderStageIDs, ResourceHandle<Shader>> m_Programs;
+	/* Preprocessed source -> compiled stage object. Keys view either embedded sources or m_StageSources */
+	std::unordered_map<std::string_view, unsigned int> m_Stages[SHADER_STAGE_COUNT];
+	/* Copies of the non-embedded keys, by stage object id so a stage that's forgotten takes its copy with it.
+	 * Node based, so the strings stay put as it grows */
+	std::unordered_map<unsigned int, std::string> m_StageSources;
+	ResourceRegistry& m_Resources;
+	JobSystem* m_Jobs;
+
+	struct PendingProgram {
+		std::string Path;
+		ShaderDefines Defines;
+		ShaderProgramSource Source;   /* Empty for embedded shaders */
+		std::string_view Stages[SHADER_STAGE_COUNT];
+		ShaderUniformLocationView Locations;
+		bool Embedded;
+		double PreprocessTime;
+		double LinkTime;
+		ShaderStageIDs StageIDs;
+		unsigned int Program;
+	};
+
+	/* With pending set the compile is only started, and the id is added to pending to be checked later.
+	 * Embedded sources live as long as the executable, anything else is copied into m_StageSources to be a key.
+	 * A stage the program doesn't have (empty source) is 0, and so is one that can't be compiled */
+	unsigned int GetStage(ShaderStage stage, std::string_view source, bool embedded, std::vector<unsigned int>* pending = nullptr);
+	/* Null if it doesn't link */
+	ResourceHandle<Shader> GetProgram(const std::string& name, const ShaderStageIDs& stages, ShaderUniformLocationView locations);
+	/* Compiles and links a batch, issuing all GL work before waiting on any of it */
+	void BuildBatch(std::vector<PendingProgram>& pending);
+
+public:
+	ShaderLibrary(ResourceRegistry& resources);
+	~ShaderLibrary();
+
+	/* A null handle if a stage fails to compile or the program fails to link, after printing why */
+	ResourceHandle<Shader> Get(const std::string& filepath, const ShaderDefines& defines = {});
+
+	/* Builds every .shader file in directory up front, once per define set.
+	 * Files are read and preprocessed as jobs when there's a job system (see SetJobSystem). Compiles and links
+	 * are then all issued from this (the gl) thread before any result is checked, so the driver can overlap them.
+	 * Prints total and per program times.
+	 */
+	void PreWarm(const std::string& directory, const std::vector<ShaderDefines>& variants = { {} });
+	/* Same for the shaders built into the executable. No file I/O and no source strings are built */
+	void PreWarmEmbedded();
+
+	/* Used by PreWarm. Without one, files are preprocessed one after another on the calling thread */
+	inline void SetJobSystem(JobSystem* jobs) { m_Jobs = jobs; }
+
+	/* Destroys every program the library built and queues the stage objects for deletion. Handles still held
+	 * elsewhere (materials, say) go stale, so their draws are skipped rather than using a deleted program */
+	void Clear();
+
+	inline unsigned int GetProgramCount() const { return (unsigned int)m_Programs.size(); }
+	inline unsigned int GetStageCount() const {
+		size_t count = 0;
+		for (const auto& stages : m_Stages) {
+			count += stages.size();
+		}
+		return (unsigned int)count;
+	}
+};
@@ -0,0 +1,208 @@
+#include "ShaderParser.h"
+
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+static const char* s_StageNames[SHADER_STAGE_COUNT] = {
+	"vertex", "tess_control", "tess_evaluation", "geometry", "fragment", "compute"
+};
+
+static bool IsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static std::string_view TrimLeft(std::string_view text) {
+	size_t i = 0;
+	while (i < text.size() && IsSpace(text[i])) {
+		i++;
+	}
+	return text.substr(i);
+}
+
+/* The identifier at the start of text */
+static std::string_view Word(std::string_view text) {
+	size_t i = 0;
+	while (i < text.size() && (isalnum((unsigned char)text[i]) || text[i] == '_')) {
+		i++;
+	}
+	return text.substr(0, i);
+}
+
+/* Matches layout(... location = N ...) uniform [qualifiers] type name[...]; and fills in name and location.
+ * Anything else, including layouts without a location and non uniforms, is left alone. */
+static bool ParseUniformLocation(std::string_view text, std::string_view& name, int& location) {
+	if (Word(text) != "layout") {
+		return false;
+	}
+	text = TrimLeft(text.substr(6));
+	size_t close = text.find(')');
+	if (text.empty() || text[0] != '(' || close == std::string_view::npos) {
+		return false;
+	}
+
+	std::string_view qualifiers = text.substr(1, close - 1);
+	size_t key = qualifiers.find("location");
+	if (key == std::string_view::npos) {
+		return false;
+	}
+	std::string_view value = TrimLeft(qualifiers.substr(key + 8));
+	if (value.empty() || value[0] != '=') {
+		return false;
+	}
+	value = TrimLeft(value.substr(1));
+	if (value.empty() || !isdigit((unsigned char)value[0])) {
+		return false;
+	}
+	location = 0;
+	for (size_t i = 0; i < value.size() && isdigit((unsigned char)value[i]); i++) {
+		location = location * 10 + (value[i] - '0');
+	}
+
+	std::string_view declaration = TrimLeft(text.substr(close + 1));
+	if (Word(declaration) != "uniform") {
+		return false;
+	}
+	/* The name is the last identifier before the array size, initialiser or ; */
+	declaration = declaration.substr(0, declaration.find_first_of("[=;"));
+	size_t end = declaration.size();
+	while (end > 0 && !(isalnum((unsigned char)declaration[end - 1]) || declaration[end - 1] == '_')) {
+		end--;
+	}
+	size_t begin = end;
+	while (begin > 0 && (isalnum((unsigned char)declaration[begin - 1]) || declaration[begin - 1] == '_')) {
+		begin--;
+	}
+	name = declaration.substr(begin, end - begin);
+	return !name.empty() && name != "uniform";
+}
+
+static void Report(std::vector<ShaderParseError>& errors, const std::string& filePath, unsigned int line, const std::string& message) {
+	std::cout << filePath << "(" << line << "): error: " << message << std::endl;
+	errors.push_back({ filePath, line, message });
+}
+
+/* sections is appended to. With allowTags false everything goes in the one section already in sections */
+static void Parse(std::string_view text, const std::string& filePath, bool allowTags,
+	std::vector<ShaderSection>& sections, std::vector<ShaderParseError>& errors) {
+	const char* p = text.data();
+	const char* end = p + text.size();
+	const char* textStart = nullptr;
+	unsigned int textLine = 0;
+	bool reportedStray = false;
+
+	auto flush = [&](const char* textEnd) {
+		if (textStart && !sections.empty()) {
+			sections.back().Chunks.push_back({ ShaderChunk::TEXT, std::string_view(textStart, textEnd - textStart), textLine });
+		}
+		textStart = nullptr;
+	};
+
+	for (unsigned int line = 1; p < end; line++) {
+		const char* newline = (const char*)memchr(p, '\n', end - p);
+		const char* next = newline ? newline + 1 : end;
+		std::string_view lineText(p, next - p);
+		std::string_view trimmed = TrimLeft(lineText);
+
+		bool isText = true;
+		if (!trimmed.empty() && trimmed[0] == '#') {
+			std::string_view afterHash = TrimLeft(trimmed.substr(1));
+			std::string_view directive = Word(afterHash);
+			std::string_view argument = TrimLeft(afterHash.substr(directive.size()));
+
+			if (directive == "shader") {
+				isText = false;
+				flush(p);
+				std::string_view name = Word(argument);
+				if (!allowTags) {
+					Report(errors, filePath, line, "#shader tag in an included file");
+				}
+				else {
+					ShaderStage stage = SHADER_STAGE_COUNT;
+					for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+						if (name == s_StageNames[i]) {
+							stage = (ShaderStage)i;
+						}
+					}
+					if (stage == SHADER_STAGE_COUNT) {
+						Report(errors, filePath, line, "unknown shader stage '" + std::string(name) + "'");
+					}
+					else {
+						sections.push_back({ stage, line, {}, {} });
+					}
+				}
+			}
+			else if (directive == "include") {
+				isText = false;
+				flush(p);
+				char close = argument.empty() ? 0 : (argument[0] == '<' ? '>' : argument[0] == '"' ? '"' : 0);
+				size_t closing = close ? argument.find(close, 1) : std::string_view::npos;
+				if (closing == std::string_view::npos) {
+					Report(errors, filePath, line, "malformed #include, expected \"file\" or <file>");
+				}
+				else if (!sections.empty()) {
+					sections.back().Chunks.push_back({ ShaderChunk::INCLUDE, argument.substr(1, closing - 1), line });
+				}
+			}
+			else if (directive == "version") {
+				isText = false;
+				flush(p);
+				if (!sections.empty()) {
+					sections.back().Chunks.push_back({ ShaderChunk::VERSION, lineText, line });
+				}
+			}
+		}
+
+		if (isText) {
+			if (sections.empty()) {
+				/* The old parser wrote this to ss[-1]. Blank lines and // comments are harmless, anything else is a mistake */
+				bool harmless = trimmed.empty() || trimmed[0] == '\n' || trimmed.substr(0, 2) == "//";
+				if (!harmless && !reportedStray) {
+					Report(errors, filePath, line, "text before the first #shader tag");
+					reportedStray = true;
+				}
+			}
+			else {
+				if (!textStart) {
+					textStart = p;
+					textLine = line;
+				}
+				/* One compare for most lines, only those starting with 'l' might be a layout */
+				std::string_view name;
+				int location;
+				if (!trimmed.empty() && trimmed[0] == 'l' && ParseUniformLocation(trimmed, name, location)) {
+					sections.back().Uniforms.push_back({ name, location, line });
+				}
+			}
+		}
+		p = next;
+	}
+	flush(end);
+}
+
+std::vector<ShaderSection> ShaderParser::ParseShader(std::string_view text, const std::string& filePath, std::vector<ShaderParseError>& errors) {
+	std::vector<ShaderSection> sections;
+	Parse(text, filePath, true, sections, errors);
+
+	/* Point at whichever tag comes second */
+	const ShaderSection* compute = nullptr;
+	const ShaderSection* graphics = nullptr;
+	for (const ShaderSection& section : sections) {
+		(section.Stage == COMPUTE_STAGE ? compute : graphics) = &section;
+		if (compute && graphics) {
+			Report(errors, filePath, section.Line, "compute can't be in the same program as graphics stages");
+			break;
+		}
+	}
+	return sections;
+}
+
+ShaderSection ShaderParser::ParseInclude(std::string_view text, const std::string& filePath, std::vector<ShaderParseError>& errors) {
+	std::vector<ShaderSection> sections(1, { SHADER_STAGE_COUNT, 1, {}, {} });
+	Parse(text, filePath, false, sections, errors);
+	return sections[0];
+}
+
+const char* ShaderParser::GetStageName(ShaderStage stage) {
+	return stage < SHADER_STAGE_COUNT ? s_StageNames[stage] : "unknown";
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Shader.h"
+
+/* A parse problem, reported as "file(line): message" so Visual Studio's output window can jump to it */
+struct ShaderParseError {
+	std::string File;
+	unsigned int Line;
+	std::string Message;
+};
+
+/* A run of a stage's text. Text points into the buffer that was parsed, nothing is copied */
+struct ShaderChunk {
+	enum ChunkType {
+		TEXT,     /* Whole lines, newlines included */
+		VERSION,  /* The #version line, defines get injected after it */
+		INCLUDE   /* Text is the path between the quotes of an #include */
+	};
+
+	ChunkType Type;
+	std::string_view Text;
+	unsigned int Line;
+};
+
+/* A "layout(location = N) uniform type name;" line. The text stays in its chunk as well */
+struct ShaderUniformDeclaration {
+	std::string_view Name;
+	int Location;
+	unsigned int Line;
+};
+
+/* Everything between one #shader tag and the next */
+struct ShaderSection {
+	ShaderStage Stage;
+	unsigned int Line;   /* Of the #shader tag */
+	std::vector<ShaderChunk> Chunks;
+	std::vector<ShaderUniformDeclaration> Uniforms;
+};
+
+/* Single pass over a shader file in memory (see MappedFile), recording where each stage's text is rather than
+ * copying it line by line. Stages are tagged "#shader vertex", "#shader tess_control", "#shader tess_evaluation",
+ * "#shader geometry", "#shader fragment" or "#shader compute". A stage may be split over several sections.
+ */
+class ShaderParser {
+public:
+	static std::vector<ShaderSection> ParseShader(std::string_view text, const std::string& filePath, std::vector<ShaderParseError>& errors);
+	/* Included files are a single untagged section */
+	static ShaderSection ParseInclude(std::string_view text, const std::string& filePath, std::vector<ShaderParseError>& errors);
+
+	/* The name used after #shader, eg. "tess_control" */
+	static const char* GetStageName(ShaderStage stage);
+};
@@ -0,0 +1,141 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "MappedFile.h"
+
+static std::string DirectoryOf(const std::string& filePath) {
+	size_t slash = filePath.find_last_of("/\\");
+	return slash == std::string::npos ? "" : filePath.substr(0, slash + 1);
+}
+
+static void AppendLine(std::string& out, std::string_view text) {
+	out.append(text.data(), text.size());
+	/* The last line of a file may have no newline, don't let the next chunk run into it */
+	if (!text.empty() && text.back() != '\n') {
+		out += '\n';
+	}
+}
+
+ShaderPreprocessor::ShaderPreprocessor(const ShaderDefines& defines)
+	: m_Defines(Normalise(defines)) {
+}
+
+ShaderProgramSource ShaderPreprocessor::Process(const std::string& filePath) {
+	m_Errors.clear();
+	m_UniformLocations.clear();
+
+	MappedFile file(filePath);
+	if (!file.IsOpen()) {
+		std::cout << "Failed to open shader '" << filePath << "'" << std::endl;
+		m_Errors.push_back({ filePath, 0, "can't open file" });
+		return {};
+	}
+
+	std::vector<ShaderSection> sections = ShaderParser::ParseShader(file.GetText(), filePath, m_Errors);
+
+	StageState stages[SHADER_STAGE_COUNT];
+	for (const ShaderSection& section : sections) {
+		StageState& stage = stages[section.Stage];
+		stage.Included.insert(filePath);
+
+		bool hasVersion = std::any_of(section.Chunks.begin(), section.Chunks.end(),
+			[](const ShaderChunk& chunk) { return chunk.Type == ShaderChunk::VERSION; });
+		if (!hasVersion && !stage.DefinesInjected) {
+			InjectDefines(stage);
+		}
+		AppendChunks(section.Chunks, filePath, stage);
+		AddUniformLocations(section.Uniforms, filePath);
+	}
+
+	ShaderProgramSource source;
+	for (unsigned int i = 0; i < SHADER_STAGE_COUNT; i++) {
+		source.Sources[i] = std::move(stages[i].Source);
+	}
+	source.UniformLocations = std::move(m_UniformLocations);
+	return source;
+}
+
+void ShaderPreprocessor::AppendChunks(const std::vector<ShaderChunk>& chunks, const std::string& filePath, StageState& stage) {
+	for (const ShaderChunk& chunk : chunks) {
+		switch (chunk.Type) {
+			case ShaderChunk::TEXT:
+				AppendLine(stage.Source, chunk.Text);
+				break;
+			case ShaderChunk::VERSION:
+				AppendLine(stage.Source, chunk.Text);
+				if (!stage.DefinesInjected) {
+					InjectDefines(stage);
+				}
+				break;
+			case ShaderChunk::INCLUDE:
+				AppendFile(DirectoryOf(filePath) + std::string(chunk.Text), chunk.Line, filePath, stage);
+				break;
+		}
+	}
+}
+
+void ShaderPreprocessor::AppendFile(const std::string& filePath, unsigned int includeLine, const std::string& includer, StageState& stage) {
+	/* Guards against double inclusion and include cycles */
+	if (!stage.Included.insert(filePath).second) {
+		return;
+	}
+
+	MappedFile file(filePath);
+	if (!file.IsOpen()) {
+		std::string message = "can't open include '" + filePath + "'";
+		std::cout << includer << "(" << includeLine << "): error: " << message << std::endl;
+		m_Errors.push_back({ includer, includeLine, message });
+		return;
+	}
+
+	/* The mapping only has to outlive this call, the chunks are copied into the stage here */
+	ShaderSection section = ShaderParser::ParseInclude(file.GetText(), filePath, m_Errors);
+	AppendChunks(section.Chunks, filePath, stage);
+	AddUniformLocations(section.Uniforms, filePath);
+}
+
+void ShaderPreprocessor::AddUniformLocations(const std::vector<ShaderUniformDeclaration>& uniforms, const std::string& filePath) {
+	for (const ShaderUniformDeclaration& uniform : uniforms) {
+		bool duplicate = false;
+		for (const ShaderUniformLocation& existing : m_UniformLocations) {
+			bool sameName = existing.Name == uniform.Name;
+			if (sameName != (existing.Location == uniform.Location)) {
+				std::string message = "uniform '" + std::string(uniform.Name) + "' at location " + std::to_string(uniform.Location)
+					+ " clashes with '" + existing.Name + "' at location " + std::to_string(existing.Location);
+				std::cout << filePath << "(" << uniform.Line << "): error: " << message << std::endl;
+				m_Errors.push_back({ filePath, uniform.Line, message });
+			}
+			duplicate |= sameName;
+		}
+		if (!duplicate) {
+			m_UniformLocations.push_back({ std::string(uniform.Name), uniform.Location });
+		}
+	}
+}
+
+void ShaderPreprocessor::InjectDefines(StageState& stage) {
+	for (const std::string& define : m_Defines) {
+		stage.Source += "#define ";
+		stage.Source += define;
+		stage.Source += '\n';
+	}
+	stage.DefinesInjected = true;
+}
+
+ShaderDefines ShaderPreprocessor::Normalise(const ShaderDefines& defines) {
+	ShaderDefines sorted(defines);
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+	return sorted;
+}
+
+std::string ShaderPreprocessor::JoinDefines(const ShaderDefines& defines) {
+	std::string joined;
+	for (const std::string& define : Normalise(defines)) {
+		joined += define;
+		joined += '\n';
+	}
+	return joined;
+}
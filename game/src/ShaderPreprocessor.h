@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderParser.h"
+
+/* Turns a .shader file into per-stage GLSL source.
+ * - "#shader <stage>" tags split the file into stages (see ShaderParser)
+ * - #include "file" is resolved relative to the including file. Each file is only pulled into a stage once,
+ *   so includes behave as if they all had include guards
+ * - The define set is injected straight after #version, which GLSL requires to be the first line
+ * - layout(location = N) uniforms are collected, so the program can skip looking them up after the link
+ * Files are memory mapped and parsed in one pass. The only copy made is each stage's final source.
+ */
+class ShaderPreprocessor {
+private:
+	ShaderDefines m_Defines;
+	std::vector<ShaderParseError> m_Errors;
+	ShaderUniformLocations m_UniformLocations;
+
+	struct StageState {
+		std::string Source;
+		std::unordered_set<std::string> Included;
+		bool DefinesInjected = false;
+	};
+
+	void AppendChunks(const std::vector<ShaderChunk>& chunks, const std::string& filePath, StageState& stage);
+	void AppendFile(const std::string& filePath, unsigned int includeLine, const std::string& includer, StageState& stage);
+	void InjectDefines(StageState& stage);
+	/* Stages may share a uniform, but only at the same location */
+	void AddUniformLocations(const std::vector<ShaderUniformDeclaration>& uniforms, const std::string& filePath);
+
+public:
+	ShaderPreprocessor(const ShaderDefines& defines);
+
+	ShaderProgramSource Process(const std::string& filePath);
+
+	/* Everything reported by the last Process, also printed as it's found */
+	inline const std::vector<ShaderParseError>& GetErrors() const { return m_Errors; }
+
+	/* Sorted and de-duplicated, so { "FOG", "SKINNING" } and { "SKINNING", "FOG" } are the same variant */
+	static ShaderDefines Normalise(const ShaderDefines& defines);
+	/* Normalised and one per line, so equal strings mean the same variant. Used as a key rather than a hash of it,
+	 * two define sets can't end up sharing a program by colliding */
+	static std::string JoinDefines(const ShaderDefines& defines);
+};
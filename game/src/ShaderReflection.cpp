@@ -0,0 +1,255 @@
+#include "ShaderReflection.h"
+
+#include "Renderer.h"
+
+static std::string StripArraySuffix(const char* name, int length) {
+	std::string result(name, length);
+	if (length > 3 && result.compare(length - 3, 3, "[0]") == 0) {
+		result.resize(length - 3);
+	}
+	return result;
+}
+
+ShaderReflection ShaderReflection::Reflect(unsigned int program, ShaderUniformLocationView locations) {
+	ShaderReflection reflection;
+
+	int maxLength = 0;
+	int count = 0;
+
+	/* Uniforms. Block members are included, with their block index and offset */
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+	reflection.Uniforms.reserve(count);
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int size = 0;
+		unsigned int type = 0;
+		GLCall(glGetActiveUniform(program, i, maxLength, &length, &size, &type, name.data()));
+
+		unsigned int index = i;
+		int blockIndex, offset, arrayStride, matrixStride;
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex));
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset));
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &arrayStride));
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &matrixStride));
+
+		std::string uniformName = StripArraySuffix(name.data(), length);
+		int location = -1;
+		if (blockIndex == -1) {
+			location = locations.Find(uniformName);
+#ifdef _DEBUG
+			if (location != -1) {
+				GLCall(int queried = glGetUniformLocation(program, uniformName.c_str()));
+				ASSERT(queried == location);
+			}
+#endif
+			if (location == -1) {
+				GLCall(location = glGetUniformLocation(program, uniformName.c_str()));
+			}
+		}
+		reflection.Uniforms.push_back({ uniformName, UniformID(uniformName), type, size, location,
+			blockIndex, offset, arrayStride, matrixStride });
+	}
+
+	/* Uniform blocks */
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int dataSize = 0;
+		int binding = 0;
+		GLCall(glGetActiveUniformBlockName(program, i, maxLength, &length, name.data()));
+		GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+		GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding));
+
+		ShaderUniformBlockInfo block = { std::string(name.data(), length), (unsigned int)i, dataSize, binding, {} };
+		for (unsigned int u = 0; u < reflection.Uniforms.size(); u++) {
+			if (reflection.Uniforms[u].BlockIndex == i) {
+				block.Uniforms.push_back(u);
+			}
+		}
+		reflection.UniformBlocks.push_back(block);
+	}
+
+	/* Vertex attributes */
+	GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int size = 0;
+		unsigned int type = 0;
+		GLCall(glGetActiveAttrib(program, i, maxLength, &length, &size, &type, name.data()));
+		std::string attributeName(name.data(), length);
+		GLCall(int location = glGetAttribLocation(program, attributeName.c_str()));
+		reflection.Attributes.push_back({ attributeName, type, size, location });
+	}
+
+	return reflection;
+}
+
+const ShaderUniformInfo* ShaderReflection::FindUniform(UniformID uniform) const {
+	for (const ShaderUniformInfo& info : Uniforms) {
+		if (info.ID.GetIndex() == uniform.GetIndex()) {
+			return &info;
+		}
+	}
+	return nullptr;
+}
+
+const ShaderUniformBlockInfo* ShaderReflection::FindUniformBlock(const std::string& name) const {
+	for (const ShaderUniformBlockInfo& block : UniformBlocks) {
+		if (block.Name == name) {
+			return &block;
+		}
+	}
+	return nullptr;
+}
+
+const ShaderAttributeInfo* ShaderReflection::FindAttribute(const std::string& name) const {
+	for (const ShaderAttributeInfo& attribute : Attributes) {
+		if (attribute.Name == name) {
+			return &attribute;
+		}
+	}
+	return nullptr;
+}
+
+unsigned int ShaderReflection::GetSizeOfType(unsigned int type) {
+	switch (type) {
+		case GL_FLOAT: return 4;
+		case GL_FLOAT_VEC2: return 8;
+		case GL_FLOAT_VEC3: return 12;
+		case GL_FLOAT_VEC4: return 16;
+		case GL_DOUBLE: return 8;
+		case GL_DOUBLE_VEC2: return 16;
+		case GL_DOUBLE_VEC3: return 24;
+		case GL_DOUBLE_VEC4: return 32;
+		case GL_INT: return 4;
+		case GL_INT_VEC2: return 8;
+		case GL_INT_VEC3: return 12;
+		case GL_INT_VEC4: return 16;
+		case GL_UNSIGNED_INT: return 4;
+		case GL_UNSIGNED_INT_VEC2: return 8;
+		case GL_UNSIGNED_INT_VEC3: return 12;
+		case GL_UNSIGNED_INT_VEC4: return 16;
+		case GL_BOOL: return 4;
+		case GL_BOOL_VEC2: return 8;
+		case GL_BOOL_VEC3: return 12;
+		case GL_BOOL_VEC4: return 16;
+		case GL_FLOAT_MAT2: return 16;
+		case GL_FLOAT_MAT3: return 36;
+		case GL_FLOAT_MAT4: return 64;
+		case GL_FLOAT_MAT2x3: return 24;
+		case GL_FLOAT_MAT2x4: return 32;
+		case GL_FLOAT_MAT3x2: return 24;
+		case GL_FLOAT_MAT3x4: return 48;
+		case GL_FLOAT_MAT4x2: return 32;
+		case GL_FLOAT_MAT4x3: return 48;
+		case GL_DOUBLE_MAT2: return 32;
+		case GL_DOUBLE_MAT3: return 72;
+		case GL_DOUBLE_MAT4: return 128;
+		case GL_DOUBLE_MAT2x3: return 48;
+		case GL_DOUBLE_MAT2x4: return 64;
+		case GL_DOUBLE_MAT3x2: return 48;
+		case GL_DOUBLE_MAT3x4: return 96;
+		case GL_DOUBLE_MAT4x2: return 64;
+		case GL_DOUBLE_MAT4x3: return 96;
+	}
+	/* Samplers and images are opaque and set with a single int */
+	if (IsSamplerType(type) || IsImageType(type)) {
+		return 4;
+	}
+	std::cout << "Warning: no size known for uniform type 0x" << std::hex << type << std::dec << std::endl;
+	ASSERT(false);
+	return 4;
+}
+
+bool ShaderReflection::IsSamplerType(unsigned int type) {
+	switch (type) {
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_1D_SHADOW:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_1D_ARRAY:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_1D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+		case GL_SAMPLER_BUFFER:
+		case GL_SAMPLER_2D_RECT:
+		case GL_SAMPLER_2D_RECT_SHADOW:
+		case GL_INT_SAMPLER_1D:
+		case GL_INT_SAMPLER_2D:
+		case GL_INT_SAMPLER_3D:
+		case GL_INT_SAMPLER_CUBE:
+		case GL_INT_SAMPLER_1D_ARRAY:
+		case GL_INT_SAMPLER_2D_ARRAY:
+		case GL_INT_SAMPLER_2D_MULTISAMPLE:
+		case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_INT_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D_RECT:
+		case GL_UNSIGNED_INT_SAMPLER_1D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_3D:
+		case GL_UNSIGNED_INT_SAMPLER_CUBE:
+		case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+		case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+			return true;
+	}
+	return false;
+}
+
+bool ShaderReflection::IsImageType(unsigned int type) {
+	switch (type) {
+		case GL_IMAGE_1D:
+		case GL_IMAGE_2D:
+		case GL_IMAGE_3D:
+		case GL_IMAGE_2D_RECT:
+		case GL_IMAGE_CUBE:
+		case GL_IMAGE_BUFFER:
+		case GL_IMAGE_1D_ARRAY:
+		case GL_IMAGE_2D_ARRAY:
+		case GL_IMAGE_CUBE_MAP_ARRAY:
+		case GL_IMAGE_2D_MULTISAMPLE:
+		case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+		case GL_INT_IMAGE_1D:
+		case GL_INT_IMAGE_2D:
+		case GL_INT_IMAGE_3D:
+		case GL_INT_IMAGE_2D_RECT:
+		case GL_INT_IMAGE_CUBE:
+		case GL_INT_IMAGE_BUFFER:
+		case GL_INT_IMAGE_1D_ARRAY:
+		case GL_INT_IMAGE_2D_ARRAY:
+		case GL_INT_IMAGE_CUBE_MAP_ARRAY:
+		case GL_INT_IMAGE_2D_MULTISAMPLE:
+		case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+		case GL_UNSIGNED_INT_IMAGE_1D:
+		case GL_UNSIGNED_INT_IMAGE_2D:
+		case GL_UNSIGNED_INT_IMAGE_3D:
+		case GL_UNSIGNED_INT_IMAGE_2D_RECT:
+		case GL_UNSIGNED_INT_IMAGE_CUBE:
+		case GL_UNSIGNED_INT_IMAGE_BUFFER:
+		case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+		case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+		case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+		case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+		case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+			return true;
+	}
+	return false;
+}
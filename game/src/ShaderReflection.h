@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "UniformID.h"
+
+/* Everything glGetActive* tells us about a linked program, gathered once straight after glLinkProgram */
+struct ShaderUniformInfo {
+	std::string Name;     /* Arrays are stored without the "[0]" GL appends */
+	UniformID ID;
+	unsigned int Type;    /* GL_FLOAT_VEC4, GL_FLOAT_MAT4 etc */
+	int Size;             /* Array length, 1 for non arrays */
+	int Location;         /* -1 for uniforms that live in a block */
+	int BlockIndex;       /* -1 for uniforms in the default block */
+	int Offset;           /* Byte offset within the block */
+	int ArrayStride;
+	int MatrixStride;
+};
+
+/* A uniform whose location the source fixes with layout(location = N) (GL 4.3 / ARB_explicit_uniform_location) */
+struct ShaderUniformLocation {
+	std::string Name;
+	int Location;
+};
+
+typedef std::vector<ShaderUniformLocation> ShaderUniformLocations;
+
+/* The same, for a shader built into the executable (see EmbeddedShader.h). Literal, so the table is constant data */
+struct EmbeddedUniformLocation {
+	std::string_view Name;
+	int Location;
+};
+
+/* Explicit locations for Reflect to look up, viewed where they already are rather than copied: the preprocessor's
+ * ShaderUniformLocations for a file, or a built in shader's table. Whatever it views has to outlive the link */
+class ShaderUniformLocationView {
+private:
+	const ShaderUniformLocation* m_Parsed;
+	const EmbeddedUniformLocation* m_Embedded;
+	size_t m_Count;
+
+public:
+	inline ShaderUniformLocationView()
+		: m_Parsed(nullptr), m_Embedded(nullptr), m_Count(0) {
+	}
+	inline ShaderUniformLocationView(const ShaderUniformLocations& locations)
+		: m_Parsed(locations.data()), m_Embedded(nullptr), m_Count(locations.size()) {
+	}
+	inline ShaderUniformLocationView(const EmbeddedUniformLocation* locations, size_t count)
+		: m_Parsed(nullptr), m_Embedded(locations), m_Count(count) {
+	}
+
+	/* -1 when the source didn't give one */
+	inline int Find(std::string_view name) const {
+		for (size_t i = 0; i < m_Count; i++) {
+			if (m_Parsed ? m_Parsed[i].Name == name : m_Embedded[i].Name == name) {
+				return m_Parsed ? m_Parsed[i].Location : m_Embedded[i].Location;
+			}
+		}
+		return -1;
+	}
+};
+
+struct ShaderUniformBlockInfo {
+	std::string Name;
+	unsigned int Index;
+	int DataSize;         /* Bytes the buffer bound to this block must hold */
+	int Binding;
+	std::vector<unsigned int> Uniforms;  /* Indices into ShaderReflection::Uniforms */
+};
+
+struct ShaderAttributeInfo {
+	std::string Name;
+	unsigned int Type;
+	int Size;
+	int Location;
+};
+
+class ShaderReflection {
+public:
+	std::vector<ShaderUniformInfo> Uniforms;
+	std::vector<ShaderUniformBlockInfo> UniformBlocks;
+	std::vector<ShaderAttributeInfo> Attributes;
+
+	/* Uniforms in locations are taken at their declared location rather than asked for with glGetUniformLocation */
+	static ShaderReflection Reflect(unsigned int program, ShaderUniformLocationView locations = {});
+
+	const ShaderUniformInfo* FindUniform(UniformID uniform) const;
+	const ShaderUniformBlockInfo* FindUniformBlock(const std::string& name) const;
+	const ShaderAttributeInfo* FindAttribute(const std::string& name) const;
+
+	/* Bytes a single value of a GL uniform type takes in the default block */
+	static unsigned int GetSizeOfType(unsigned int type);
+	static bool IsSamplerType(unsigned int type);
+	/* image* uniforms, bound to image units like samplers are to texture units */
+	static bool IsImageType(unsigned int type);
+};
@@ -0,0 +1,61 @@
+#include "ShaderStorageBuffer.h"
+#include "Renderer.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(unsigned int size, const void* data)
+	: m_Size(size) {
+	ASSERT(Shader::HasComputeShaders());
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	/* Written by the GPU and read by the GPU, the CPU only seeds it */
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_COPY));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer() {
+	DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+}
+
+ShaderStorageBuffer::ShaderStorageBuffer(ShaderStorageBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Size(other.m_Size) {
+	other.m_RendererID = 0;
+	other.m_Size = 0;
+}
+
+ShaderStorageBuffer& ShaderStorageBuffer::operator=(ShaderStorageBuffer&& other) noexcept {
+	if (this != &other) {
+		DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_Size = other.m_Size;
+		other.m_RendererID = 0;
+		other.m_Size = 0;
+	}
+	return *this;
+}
+
+void ShaderStorageBuffer::SetData(const void* data, unsigned int size, unsigned int offset) {
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::GetData(void* data, unsigned int size, unsigned int offset) const {
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int binding) const {
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_RendererID));
+}
+
+void ShaderStorageBuffer::BindRange(unsigned int binding, unsigned int offset, unsigned int size) const {
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_RendererID, offset, size));
+}
+
+void ShaderStorageBuffer::Bind() const {
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+}
+
+void ShaderStorageBuffer::Unbind() const {
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+}
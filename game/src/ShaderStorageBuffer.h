@@ -0,0 +1,35 @@
+#pragma once
+
+/* A GL_SHADER_STORAGE_BUFFER (GL 4.3 / ARB_shader_storage_buffer_object). Unlike a uniform buffer, shaders can
+ * write to it and it can be far bigger, so it's where compute programs keep particles, cull results and the like.
+ * The same buffer can be bound as a vertex or indirect draw buffer through GetRendererID() once a barrier has
+ * been issued (see Renderer::VertexBarrier).
+ */
+class ShaderStorageBuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+public:
+	/* data may be nullptr to just reserve size bytes */
+	ShaderStorageBuffer(unsigned int size, const void* data = nullptr);
+	~ShaderStorageBuffer();
+	/* Move-only, a moved-from buffer holds 0 and a size of 0 */
+	ShaderStorageBuffer(ShaderStorageBuffer&& other) noexcept;
+	ShaderStorageBuffer& operator=(ShaderStorageBuffer&& other) noexcept;
+	ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+	ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+	/* Reads back into data. Stalls until the GPU is done with the buffer, so keep it to debugging and tools */
+	void GetData(void* data, unsigned int size, unsigned int offset = 0) const;
+
+	/* Attach to an indexed binding point, matching layout(binding = N) or Shader::SetStorageBlockBinding */
+	void BindBase(unsigned int binding) const;
+	void BindRange(unsigned int binding, unsigned int offset, unsigned int size) const;
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+/* Picks the instruction set the SIMD paths are compiled for. There's no runtime dispatch:
+ * - SIMD_AVX when the compiler targets AVX (/arch:AVX), which also implies SIMD_SSE
+ * - SIMD_SSE on any x86/x64 build, SSE2 is the baseline there
+ * - Neither elsewhere, and everything falls back to plain loops
+ */
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_AVX
+#define SIMD_SSE
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define SIMD_SSE
+#endif
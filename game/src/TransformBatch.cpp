@@ -0,0 +1,163 @@
+#include "TransformBatch.h"
+
+#include "Simd.h"
+
+void TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count) {
+	const float* m = matrix.GetData();
+	unsigned int i = 0;
+
+#if defined(SIMD_AVX)
+	/* Each matrix element broadcast once, then each lane is a different point */
+	__m256 m00 = _mm256_set1_ps(m[0]), m01 = _mm256_set1_ps(m[4]), m02 = _mm256_set1_ps(m[8]), m03 = _mm256_set1_ps(m[12]);
+	__m256 m10 = _mm256_set1_ps(m[1]), m11 = _mm256_set1_ps(m[5]), m12 = _mm256_set1_ps(m[9]), m13 = _mm256_set1_ps(m[13]);
+	__m256 m20 = _mm256_set1_ps(m[2]), m21 = _mm256_set1_ps(m[6]), m22 = _mm256_set1_ps(m[10]), m23 = _mm256_set1_ps(m[14]);
+	for (; i + 8 <= count; i += 8) {
+		__m256 px = _mm256_loadu_ps(x + i);
+		__m256 py = _mm256_loadu_ps(y + i);
+		__m256 pz = _mm256_loadu_ps(z + i);
+		__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, px), _mm256_mul_ps(m01, py)), _mm256_add_ps(_mm256_mul_ps(m02, pz), m03));
+		__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, px), _mm256_mul_ps(m11, py)), _mm256_add_ps(_mm256_mul_ps(m12, pz), m13));
+		__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, px), _mm256_mul_ps(m21, py)), _mm256_add_ps(_mm256_mul_ps(m22, pz), m23));
+		_mm256_storeu_ps(outX + i, rx);
+		_mm256_storeu_ps(outY + i, ry);
+		_mm256_storeu_ps(outZ + i, rz);
+	}
+#elif defined(SIMD_SSE)
+	__m128 m00 = _mm_set1_ps(m[0]), m01 = _mm_set1_ps(m[4]), m02 = _mm_set1_ps(m[8]), m03 = _mm_set1_ps(m[12]);
+	__m128 m10 = _mm_set1_ps(m[1]), m11 = _mm_set1_ps(m[5]), m12 = _mm_set1_ps(m[9]), m13 = _mm_set1_ps(m[13]);
+	__m128 m20 = _mm_set1_ps(m[2]), m21 = _mm_set1_ps(m[6]), m22 = _mm_set1_ps(m[10]), m23 = _mm_set1_ps(m[14]);
+	for (; i + 4 <= count; i += 4) {
+		__m128 px = _mm_loadu_ps(x + i);
+		__m128 py = _mm_loadu_ps(y + i);
+		__m128 pz = _mm_loadu_ps(z + i);
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m01, py)), _mm_add_ps(_mm_mul_ps(m02, pz), m03));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, px), _mm_mul_ps(m11, py)), _mm_add_ps(_mm_mul_ps(m12, pz), m13));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, px), _mm_mul_ps(m21, py)), _mm_add_ps(_mm_mul_ps(m22, pz), m23));
+		_mm_storeu_ps(outX + i, rx);
+		_mm_storeu_ps(outY + i, ry);
+		_mm_storeu_ps(outZ + i, rz);
+	}
+#endif
+
+	for (; i < count; i++) {
+		float px = x[i], py = y[i], pz = z[i];
+		outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+		outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+		outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+	}
+}
+
+#if defined(SIMD_AVX)
+/* Two columns of left * right per 256 bit register. a holds left's columns repeated in both halves,
+ * and the in-lane permute splats a component of right's column k in the low half and column k + 1 in the high half.
+ */
+static inline void MultiplyAvx(const __m256 a[4], const Mat4& right, Mat4& out) {
+	for (int column = 0; column < 4; column += 2) {
+		__m256 b = _mm256_loadu_ps(&right.Columns[column].x);
+		__m256 sum = _mm256_mul_ps(a[0], _mm256_permute_ps(b, 0x00));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(a[1], _mm256_permute_ps(b, 0x55)));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(a[2], _mm256_permute_ps(b, 0xAA)));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(a[3], _mm256_permute_ps(b, 0xFF)));
+		_mm256_storeu_ps(&out.Columns[column].x, sum);
+	}
+}
+
+static inline void LoadAvx(const Mat4& left, __m256 a[4]) {
+	for (int column = 0; column < 4; column++) {
+		a[column] = _mm256_broadcast_ps((const __m128*)&left.Columns[column].x);
+	}
+}
+#endif
+
+void MultiplyMatrices(const Mat4& left, const Mat4* right, Mat4* out, unsigned int count) {
+#if defined(SIMD_AVX)
+	__m256 a[4];
+	LoadAvx(left, a);
+	for (unsigned int i = 0; i < count; i++) {
+		MultiplyAvx(a, right[i], out[i]);
+	}
+#else
+	/* Copied in case left is itself one of the outputs */
+	Mat4 l = left;
+	for (unsigned int i = 0; i < count; i++) {
+		out[i] = l * right[i];
+	}
+#endif
+}
+
+void MultiplyMatrices(const Mat4* left, const Mat4* right, Mat4* out, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+#if defined(SIMD_AVX)
+		/* right's columns are read a pair at a time before that pair is written, so out may alias either input */
+		__m256 a[4];
+		LoadAvx(left[i], a);
+		MultiplyAvx(a, right[i], out[i]);
+#else
+		out[i] = left[i] * right[i];
+#endif
+	}
+}
+
+void ComposeMatrices(const TransformArrays& t, Mat4* out, unsigned int count) {
+	unsigned int i = 0;
+
+#if defined(SIMD_SSE)
+	/* Same maths as Mat4::Rotation, one transform per lane, then a 4x4 transpose turns
+	 * "element e of four matrices" into "column c of one matrix" for the stores.
+	 */
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		__m128 qx = _mm_loadu_ps(t.RotationX + i);
+		__m128 qy = _mm_loadu_ps(t.RotationY + i);
+		__m128 qz = _mm_loadu_ps(t.RotationZ + i);
+		__m128 qw = _mm_loadu_ps(t.RotationW + i);
+		__m128 sx = _mm_loadu_ps(t.ScaleX + i);
+		__m128 sy = _mm_loadu_ps(t.ScaleY + i);
+		__m128 sz = _mm_loadu_ps(t.ScaleZ + i);
+
+		__m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+		__m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+		__m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+		__m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		__m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		__m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		__m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		__m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		__m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		__m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		__m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		__m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		__m128 c3x = _mm_loadu_ps(t.PositionX + i);
+		__m128 c3y = _mm_loadu_ps(t.PositionY + i);
+		__m128 c3z = _mm_loadu_ps(t.PositionZ + i);
+
+		__m128 c0w = zero, c1w = zero, c2w = zero, c3w = one;
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+		_MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+
+		/* After the transposes the x register holds the first transform's column, y the second's, and so on */
+		__m128 columns[4][4] = {
+			{ c0x, c1x, c2x, c3x },
+			{ c0y, c1y, c2y, c3y },
+			{ c0z, c1z, c2z, c3z },
+			{ c0w, c1w, c2w, c3w }
+		};
+		for (int lane = 0; lane < 4; lane++) {
+			for (int column = 0; column < 4; column++) {
+				_mm_store_ps(&out[i + lane].Columns[column].x, columns[lane][column]);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		Quat rotation = { t.RotationX[i], t.RotationY[i], t.RotationZ[i], t.RotationW[i] };
+		out[i] = Mat4::FromTRS({ t.PositionX[i], t.PositionY[i], t.PositionZ[i] }, rotation, { t.ScaleX[i], t.ScaleY[i], t.ScaleZ[i] });
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Matrix.h"
+
+/* Translation, rotation and scale for many objects, one array per component. Every array holds count floats.
+ * The arrays don't need to be aligned, but the kernels read them a full register at a time,
+ * so keep components of the same object at the same index and nothing else in between.
+ */
+struct TransformArrays {
+	const float* PositionX;
+	const float* PositionY;
+	const float* PositionZ;
+	const float* RotationX;
+	const float* RotationY;
+	const float* RotationZ;
+	const float* RotationW;
+	const float* ScaleX;
+	const float* ScaleY;
+	const float* ScaleZ;
+};
+
+/* Batch kernels over whole arrays, 8 wide with AVX, 4 with SSE, scalar for the remainder and elsewhere.
+ * Outputs may alias inputs of the same shape, so points can be transformed in place.
+ */
+
+/* out = matrix * (x, y, z, 1) for each point, without the divide by w */
+void TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count);
+
+/* out[i] = left * right[i], eg. view projection * each model matrix */
+void MultiplyMatrices(const Mat4& left, const Mat4* right, Mat4* out, unsigned int count);
+/* out[i] = left[i] * right[i], eg. parent world * local for a level of a hierarchy */
+void MultiplyMatrices(const Mat4* left, const Mat4* right, Mat4* out, unsigned int count);
+
+/* out[i] = Mat4::FromTRS for each transform. Works across transforms, so it runs 4 wide even without AVX */
+void ComposeMatrices(const TransformArrays& transforms, Mat4* out, unsigned int count);
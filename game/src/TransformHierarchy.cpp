@@ -0,0 +1,342 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "Renderer.h"
+
+/* Reorders v so that v[i] becomes the old v[from[i]] */
+template<typename T>
+static void Gather(std::vector<T>& v, const std::vector<unsigned int>& from) {
+	std::vector<T> gathered(v.size());
+	for (size_t i = 0; i < from.size(); i++) {
+		gathered[i] = v[from[i]];
+	}
+	v.swap(gathered);
+}
+
+TransformHierarchy::TransformHierarchy()
+	: m_OrderDirty(false), m_SplitDirty(true), m_Jobs(nullptr), m_Stats({ 0, 0, 0 }) {
+}
+
+unsigned int TransformHierarchy::Add(unsigned int parent) {
+	ASSERT(parent == NONE || parent < m_Index.size());
+	unsigned int id = (unsigned int)m_Index.size();
+	unsigned int index = (unsigned int)m_ID.size();
+	unsigned int parentIndex = parent == NONE ? NONE : m_Index[parent];
+
+	/* Still depth first if the parent's subtree is the last thing in the arrays, the new node then just extends it */
+	if (parentIndex != NONE && !m_OrderDirty) {
+		if (parentIndex + m_SubtreeSize[parentIndex] == index) {
+			for (unsigned int p = parentIndex; p != NONE; p = m_Parent[p]) {
+				m_SubtreeSize[p]++;
+			}
+		}
+		else {
+			m_OrderDirty = true;
+		}
+	}
+	m_SplitDirty = true;
+
+	m_Parent.push_back(parentIndex);
+	m_SubtreeSize.push_back(1);
+	for (std::vector<float>* zero : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY, &m_RotationZ }) {
+		zero->push_back(0.0f);
+	}
+	for (std::vector<float>* one : { &m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ }) {
+		one->push_back(1.0f);
+	}
+	m_Local.push_back(Mat4::Identity());
+	m_World.push_back(Mat4::Identity());
+	m_LocalDirty.push_back(0);
+	m_DirtyBelow.push_back(0);
+	m_WorldChanged.push_back(0);
+	m_ID.push_back(id);
+
+	m_Index.push_back(index);
+	m_ParentID.push_back(parent);
+
+	/* Its world matrix has to pick up the parent's */
+	MarkDirty(index);
+	return id;
+}
+
+void TransformHierarchy::SetParent(unsigned int node, unsigned int parent) {
+	/* Can't be parented to itself or anything below it */
+	for (unsigned int p = parent; p != NONE; p = m_ParentID[p]) {
+		ASSERT(p != node);
+	}
+	m_ParentID[node] = parent;
+	m_Parent[m_Index[node]] = parent == NONE ? NONE : m_Index[parent];
+	m_OrderDirty = true;
+	m_SplitDirty = true;
+	MarkDirty(m_Index[node]);
+}
+
+void TransformHierarchy::Clear() {
+	for (std::vector<unsigned int>* array : { &m_Parent, &m_SubtreeSize, &m_ID, &m_Index, &m_ParentID, &m_SerialNodes }) {
+		array->clear();
+	}
+	for (std::vector<float>* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY, &m_RotationZ,
+		&m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ }) {
+		array->clear();
+	}
+	for (std::vector<unsigned char>* array : { &m_LocalDirty, &m_DirtyBelow, &m_WorldChanged }) {
+		array->clear();
+	}
+	m_Local.clear();
+	m_World.clear();
+	m_Ranges.clear();
+	m_OrderDirty = false;
+	m_SplitDirty = true;
+}
+
+void TransformHierarchy::SetPosition(unsigned int node, const Vec3& position) {
+	unsigned int index = m_Index[node];
+	m_PositionX[index] = position.x;
+	m_PositionY[index] = position.y;
+	m_PositionZ[index] = position.z;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetRotation(unsigned int node, const Quat& rotation) {
+	unsigned int index = m_Index[node];
+	m_RotationX[index] = rotation.x;
+	m_RotationY[index] = rotation.y;
+	m_RotationZ[index] = rotation.z;
+	m_RotationW[index] = rotation.w;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetScale(unsigned int node, const Vec3& scale) {
+	unsigned int index = m_Index[node];
+	m_ScaleX[index] = scale.x;
+	m_ScaleY[index] = scale.y;
+	m_ScaleZ[index] = scale.z;
+	MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocal(unsigned int node, const Vec3& position, const Quat& rotation, const Vec3& scale) {
+	SetPosition(node, position);
+	SetRotation(node, rotation);
+	SetScale(node, scale);
+}
+
+Vec3 TransformHierarchy::GetPosition(unsigned int node) const {
+	unsigned int index = m_Index[node];
+	return { m_PositionX[index], m_PositionY[index], m_PositionZ[index] };
+}
+
+Quat TransformHierarchy::GetRotation(unsigned int node) const {
+	unsigned int index = m_Index[node];
+	return { m_RotationX[index], m_RotationY[index], m_RotationZ[index], m_RotationW[index] };
+}
+
+Vec3 TransformHierarchy::GetScale(unsigned int node) const {
+	unsigned int index = m_Index[node];
+	return { m_ScaleX[index], m_ScaleY[index], m_ScaleZ[index] };
+}
+
+void TransformHierarchy::MarkDirty(unsigned int index) {
+	m_LocalDirty[index] = 1;
+	/* Stops at the first ancestor that's already flagged, everything above it is too.
+	 * Parent positions are out of date while a re-sort is pending, and the sort recomputes these anyway */
+	if (!m_OrderDirty) {
+		for (unsigned int p = m_Parent[index]; p != NONE && !m_DirtyBelow[p]; p = m_Parent[p]) {
+			m_DirtyBelow[p] = 1;
+		}
+	}
+}
+
+void TransformHierarchy::Sort() {
+	unsigned int count = GetCount();
+
+	/* Children as linked lists by ID */
+	std::vector<unsigned int> firstChild(count, NONE);
+	std::vector<unsigned int> nextSibling(count, NONE);
+	for (unsigned int id = count; id-- > 0;) {
+		unsigned int parent = m_ParentID[id];
+		if (parent != NONE) {
+			nextSibling[id] = firstChild[parent];
+			firstChild[parent] = id;
+		}
+	}
+
+	/* Depth first from each root, which makes every subtree contiguous */
+	std::vector<unsigned int> order;
+	order.reserve(count);
+	std::vector<unsigned int> stack;
+	for (unsigned int root = 0; root < count; root++) {
+		if (m_ParentID[root] != NONE) {
+			continue;
+		}
+		stack.push_back(root);
+		while (!stack.empty()) {
+			unsigned int id = stack.back();
+			stack.pop_back();
+			order.push_back(id);
+			for (unsigned int child = firstChild[id]; child != NONE; child = nextSibling[child]) {
+				stack.push_back(child);
+			}
+		}
+	}
+	ASSERT(order.size() == count);
+
+	std::vector<unsigned int> from(count);
+	for (unsigned int i = 0; i < count; i++) {
+		from[i] = m_Index[order[i]];
+	}
+	for (std::vector<float>* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY, &m_RotationZ,
+		&m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ }) {
+		Gather(*array, from);
+	}
+	Gather(m_Local, from);
+	Gather(m_World, from);
+	Gather(m_LocalDirty, from);
+
+	m_ID = order;
+	for (unsigned int i = 0; i < count; i++) {
+		m_Index[order[i]] = i;
+	}
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int parent = m_ParentID[order[i]];
+		m_Parent[i] = parent == NONE ? NONE : m_Index[parent];
+	}
+
+	/* Children come after their parents, so one backwards pass totals the subtrees */
+	std::fill(m_SubtreeSize.begin(), m_SubtreeSize.end(), 1);
+	std::fill(m_DirtyBelow.begin(), m_DirtyBelow.end(), 0);
+	std::fill(m_WorldChanged.begin(), m_WorldChanged.end(), 0);
+	for (unsigned int i = count; i-- > 0;) {
+		unsigned int parent = m_Parent[i];
+		if (parent != NONE) {
+			m_SubtreeSize[parent] += m_SubtreeSize[i];
+			m_DirtyBelow[parent] |= m_LocalDirty[i] | m_DirtyBelow[i];
+		}
+	}
+	m_OrderDirty = false;
+}
+
+void TransformHierarchy::Split() {
+	m_SerialNodes.clear();
+	m_Ranges.clear();
+
+	unsigned int count = GetCount();
+	unsigned int target = std::max(1u, count / (m_Jobs->GetWorkerCount() * RANGES_PER_WORKER));
+
+	/* Subtrees that are small enough become ranges. Bigger ones have their root done serially and their
+	 * children's subtrees considered in turn. Nodes come off the stack parents first, so that's also the
+	 * order the serial nodes have to be updated in */
+	std::vector<unsigned int> stack;
+	for (unsigned int root = 0; root < count; root += m_SubtreeSize[root]) {
+		stack.push_back(root);
+	}
+	while (!stack.empty()) {
+		unsigned int node = stack.back();
+		stack.pop_back();
+		unsigned int size = m_SubtreeSize[node];
+		if (size <= target) {
+			m_Ranges.push_back({ node, node + size });
+			continue;
+		}
+		m_SerialNodes.push_back(node);
+		for (unsigned int child = node + 1; child < node + size; child += m_SubtreeSize[child]) {
+			stack.push_back(child);
+		}
+	}
+	m_SplitDirty = false;
+}
+
+TransformArrays TransformHierarchy::GetArrays(unsigned int index) const {
+	return {
+		&m_PositionX[index], &m_PositionY[index], &m_PositionZ[index],
+		&m_RotationX[index], &m_RotationY[index], &m_RotationZ[index], &m_RotationW[index],
+		&m_ScaleX[index], &m_ScaleY[index], &m_ScaleZ[index]
+	};
+}
+
+unsigned int TransformHierarchy::UpdateNodes(unsigned int begin, unsigned int end, unsigned int& skipped) {
+	unsigned int recomputed = 0;
+	unsigned int composedEnd = begin;
+	unsigned int i = begin;
+	while (i < end) {
+		unsigned int parent = m_Parent[i];
+		bool changed = m_LocalDirty[i] || (parent != NONE && m_WorldChanged[parent]);
+		/* Nothing here or below moved. Nodes in there keep stale m_WorldChanged flags, but only their own
+		 * children ever read those, and they're skipped along with them */
+		if (!changed && !m_DirtyBelow[i]) {
+			skipped += m_SubtreeSize[i];
+			i += m_SubtreeSize[i];
+			continue;
+		}
+
+		/* Dirty nodes tend to come in runs (a whole animated subtree), which the batch kernel does 4 at a time */
+		if (m_LocalDirty[i] && i >= composedEnd) {
+			composedEnd = i;
+			while (composedEnd < end && m_LocalDirty[composedEnd]) {
+				composedEnd++;
+			}
+			ComposeMatrices(GetArrays(i), &m_Local[i], composedEnd - i);
+		}
+
+		if (changed) {
+			m_World[i] = parent == NONE ? m_Local[i] : m_World[parent] * m_Local[i];
+			recomputed++;
+		}
+		m_WorldChanged[i] = changed;
+		m_LocalDirty[i] = 0;
+		m_DirtyBelow[i] = 0;
+		i++;
+	}
+	return recomputed;
+}
+
+void TransformHierarchy::Update() {
+	if (m_OrderDirty) {
+		Sort();
+	}
+
+	unsigned int count = GetCount();
+	unsigned int skipped = 0;
+	unsigned int recomputed = 0;
+	if (!m_Jobs || m_Jobs->GetWorkerCount() == 1 || count < PARALLEL_THRESHOLD) {
+		recomputed = UpdateNodes(0, count, skipped);
+	}
+	else {
+		if (m_SplitDirty) {
+			Split();
+		}
+		/* One at a time, each is only a single node. They always write m_WorldChanged, since the ranges below read it */
+		for (unsigned int node : m_SerialNodes) {
+			unsigned int parent = m_Parent[node];
+			bool changed = m_LocalDirty[node] || (parent != NONE && m_WorldChanged[parent]);
+			if (m_LocalDirty[node]) {
+				ComposeMatrices(GetArrays(node), &m_Local[node], 1);
+			}
+			if (changed) {
+				m_World[node] = parent == NONE ? m_Local[node] : m_World[parent] * m_Local[node];
+				recomputed++;
+			}
+			m_WorldChanged[node] = changed;
+			m_LocalDirty[node] = 0;
+			m_DirtyBelow[node] = 0;
+		}
+
+		/* The ranges share no nodes, and their parents are all done, so nothing needs a lock */
+		std::atomic<unsigned int> totalRecomputed(recomputed);
+		std::atomic<unsigned int> totalSkipped(0);
+		m_Jobs->ParallelFor(0, (unsigned int)m_Ranges.size(), 1, [this, &totalRecomputed, &totalSkipped](unsigned int begin, unsigned int end) {
+			unsigned int rangeSkipped = 0;
+			for (unsigned int r = begin; r < end; r++) {
+				totalRecomputed += UpdateNodes(m_Ranges[r].Begin, m_Ranges[r].End, rangeSkipped);
+			}
+			totalSkipped += rangeSkipped;
+		});
+		recomputed = totalRecomputed;
+		skipped = totalSkipped;
+	}
+
+	m_Stats.Updates++;
+	m_Stats.Recomputed += recomputed;
+	m_Stats.Skipped += skipped;
+}
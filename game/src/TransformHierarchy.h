@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+
+#include "JobSystem.h"
+#include "TransformBatch.h"
+
+struct TransformStats {
+	unsigned int Updates;
+	unsigned int Recomputed;   /* World matrices rebuilt */
+	unsigned int Skipped;      /* Nodes in clean subtrees that were stepped over */
+};
+
+/* Parent/child transforms for a lot of nodes, without a pointer per node.
+ * Everything is held in flat arrays, one per component, in depth first order: a parent comes before its children
+ * and each subtree is one contiguous run. That makes Update() a single forward pass where a node's parent world
+ * matrix is always ready and already in cache, and lets it hop over a whole clean subtree in one step.
+ * - Setting a local transform marks the node dirty and flags its ancestors as having something dirty below,
+ *   so Update() only walks down to what changed
+ * - Big hierarchies are cut into subtrees that are updated as jobs (see SetJobSystem). The few nodes above
+ *   the cuts are done first on the calling thread
+ * - Adding a node at the end of its parent's subtree (building depth first) keeps the order as it is.
+ *   Anything else, including SetParent(), re-sorts everything on the next Update()
+ * Nodes keep the ID Add() returned, the array positions are private.
+ */
+class TransformHierarchy {
+public:
+	static const unsigned int NONE = 0xffffffff;
+
+private:
+	/* Below this many nodes, splitting into jobs costs more than it saves */
+	static const unsigned int PARALLEL_THRESHOLD = 16384;
+	/* Subtrees per worker to aim for, so a slow one doesn't hold the others up */
+	static const unsigned int RANGES_PER_WORKER = 4;
+
+	struct UpdateRange {
+		unsigned int Begin;
+		unsigned int End;
+	};
+
+	/* By position in update order */
+	std::vector<unsigned int> m_Parent;
+	std::vector<unsigned int> m_SubtreeSize;   /* Including the node itself */
+	std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+	std::vector<float> m_RotationX, m_RotationY, m_RotationZ, m_RotationW;
+	std::vector<float> m_ScaleX, m_ScaleY, m_ScaleZ;
+	std::vector<Mat4> m_Local;
+	std::vector<Mat4> m_World;
+	/* Bytes rather than vector<bool>, so threads can write neighbouring flags */
+	std::vector<unsigned char> m_LocalDirty;
+	std::vector<unsigned char> m_DirtyBelow;
+	std::vector<unsigned char> m_WorldChanged;   /* This Update(), read by the children */
+	std::vector<unsigned int> m_ID;
+
+	/* By ID */
+	std::vector<unsigned int> m_Index;
+	std::vector<unsigned int> m_ParentID;
+
+	bool m_OrderDirty;
+	/* Work split for threaded updates, rebuilt after a re-sort */
+	std::vector<unsigned int> m_SerialNodes;
+	std::vector<UpdateRange> m_Ranges;
+	bool m_SplitDirty;
+	JobSystem* m_Jobs;
+	TransformStats m_Stats;
+
+	void MarkDirty(unsigned int index);
+	void Sort();
+	void Split();
+	TransformArrays GetArrays(unsigned int index) const;
+	/* Whole subtrees whose parents are already up to date. Returns how many nodes were recomputed */
+	unsigned int UpdateNodes(unsigned int begin, unsigned int end, unsigned int& skipped);
+
+public:
+	TransformHierarchy();
+
+	/* Identity local transform. The parent must already exist */
+	unsigned int Add(unsigned int parent = NONE);
+	/* NONE makes it a root. Takes effect, with a re-sort, on the next Update() */
+	void SetParent(unsigned int node, unsigned int parent);
+	void Clear();
+
+	void SetPosition(unsigned int node, const Vec3& position);
+	void SetRotation(unsigned int node, const Quat& rotation);
+	void SetScale(unsigned int node, const Vec3& scale);
+	void SetLocal(unsigned int node, const Vec3& position, const Quat& rotation, const Vec3& scale);
+
+	Vec3 GetPosition(unsigned int node) const;
+	Quat GetRotation(unsigned int node) const;
+	Vec3 GetScale(unsigned int node) const;
+	inline unsigned int GetParent(unsigned int node) const { return m_ParentID[node]; }
+
+	/* Brings every world matrix up to date with the local transforms */
+	void Update();
+	/* As of the last Update() */
+	inline const Mat4& GetWorld(unsigned int node) const { return m_World[m_Index[node]]; }
+
+	inline unsigned int GetCount() const { return (unsigned int)m_ID.size(); }
+	/* Without one (the default), Update() stays on the calling thread */
+	inline void SetJobSystem(JobSystem* jobs) { m_Jobs = jobs; m_SplitDirty = true; }
+	inline const TransformStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = { 0, 0, 0 }; }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+/* C++ mirrors of the uniform blocks in res/shaders/include.
+ * Blocks are declared layout(std140), so the offsets are fixed by the spec rather than the driver:
+ * - float/int align to 4, vec2 to 8, vec3 and vec4 to 16
+ * - Array elements and matrix columns are padded to 16
+ * - A block's size is rounded up to 16
+ * The Std140 types carry that alignment, and the static_asserts below catch a struct that drifts from the GLSL.
+ * Don't put a scalar straight after a Std140Vec3: GLSL packs it into the vec3's last 4 bytes, C++ won't.
+ */
+struct alignas(8) Std140Vec2 { float x, y; };
+struct alignas(16) Std140Vec3 { float x, y, z; };
+struct alignas(16) Std140Vec4 { float x, y, z, w; };
+/* Column major, as GL expects */
+struct alignas(16) Std140Mat4 { Std140Vec4 Columns[4]; };
+
+inline Std140Mat4 Std140Identity() {
+	return { {
+		{ 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 1.0f }
+	} };
+}
+
+#define STD140_CHECK_OFFSET(Block, Member, Offset) \
+	static_assert(offsetof(Block, Member) == Offset, #Block "::" #Member " is not at std140 offset " #Offset)
+#define STD140_CHECK_BLOCK(Block, Size) \
+	static_assert(std::is_standard_layout<Block>::value, #Block " must be standard layout"); \
+	static_assert(sizeof(Block) == Size, #Block " is not the std140 size " #Size); \
+	static_assert(sizeof(Block) % 16 == 0, #Block " size must be a multiple of 16")
+
+/* Binding points are shared by every program. Shader maps blocks onto these by name after linking,
+ * because GL 3.3 has no layout(binding = N) for blocks.
+ */
+enum UniformBlockBinding : unsigned int {
+	FRAME_CONSTANTS_BINDING = 0,    /* Uploaded once per frame by Renderer::BeginFrame */
+	MATERIAL_CONSTANTS_BINDING = 1, /* One UniformBuffer per material, bound before its draws */
+	OBJECT_CONSTANTS_BINDING = 2    /* A range of Renderer's ring buffer, rebound for every draw */
+};
+
+/* res/shaders/include/frame.glsl */
+struct FrameConstants {
+	Std140Mat4 ViewProjection;
+	float Time;
+	float DeltaTime;
+	float Padding[2];
+};
+STD140_CHECK_OFFSET(FrameConstants, ViewProjection, 0);
+STD140_CHECK_OFFSET(FrameConstants, Time, 64);
+STD140_CHECK_OFFSET(FrameConstants, DeltaTime, 68);
+STD140_CHECK_BLOCK(FrameConstants, 80);
+
+/* res/shaders/include/object.glsl */
+struct ObjectConstants {
+	Std140Mat4 Model;
+};
+STD140_CHECK_OFFSET(ObjectConstants, Model, 0);
+STD140_CHECK_BLOCK(ObjectConstants, 64);
+
+struct UniformBlockDescription {
+	const char* Name;
+	unsigned int Binding;
+	unsigned int Size;   /* 0 when the size varies per shader, eg. material blocks */
+};
+
+/* Every block name Shader knows how to bind */
+static const UniformBlockDescription s_UniformBlocks[] = {
+	{ "FrameConstants", FRAME_CONSTANTS_BINDING, sizeof(FrameConstants) },
+	{ "MaterialConstants", MATERIAL_CONSTANTS_BINDING, 0 },
+	{ "ObjectConstants", OBJECT_CONSTANTS_BINDING, sizeof(ObjectConstants) }
+};
@@ -0,0 +1,49 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, const void* data)
+	: m_Size(size) {
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	/* Rewritten every frame or whenever a material changes, so DYNAMIC rather than STATIC */
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW));
+}
+
+UniformBuffer::~UniformBuffer() {
+	DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Size(other.m_Size) {
+	other.m_RendererID = 0;
+	other.m_Size = 0;
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept {
+	if (this != &other) {
+		DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		m_Size = other.m_Size;
+		other.m_RendererID = 0;
+		other.m_Size = 0;
+	}
+	return *this;
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset) {
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+void UniformBuffer::BindBase(unsigned int binding) const {
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID));
+}
+
+void UniformBuffer::Bind() const {
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+}
+
+void UniformBuffer::Unbind() const {
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+}
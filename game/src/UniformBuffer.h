@@ -0,0 +1,29 @@
+#pragma once
+
+/* A GL_UNIFORM_BUFFER backing a uniform block. Bind it to a binding point once and every program whose
+ * block is mapped to that point reads from it, instead of each program getting its own glUniform* calls.
+ */
+class UniformBuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+public:
+	/* data may be nullptr to just reserve size bytes */
+	UniformBuffer(unsigned int size, const void* data = nullptr);
+	~UniformBuffer();
+	/* Move-only, a moved-from buffer holds 0 and a size of 0 */
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	/* Attach the whole buffer to an indexed binding point (see UniformBlockBinding) */
+	void BindBase(unsigned int binding) const;
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetSize() const { return m_Size; }
+};
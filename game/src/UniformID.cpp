@@ -0,0 +1,29 @@
+#include "UniformID.h"
+
+/* Function statics so IDs declared at namespace scope in other files are safe to construct */
+std::unordered_map<std::string, unsigned int>& UniformID::GetRegistry() {
+	static std::unordered_map<std::string, unsigned int> registry;
+	return registry;
+}
+
+std::vector<std::string>& UniformID::GetNames() {
+	static std::vector<std::string> names;
+	return names;
+}
+
+UniformID::UniformID(const char* name)
+	: UniformID(std::string(name)) {
+}
+
+UniformID::UniformID(const std::string& name) {
+	auto& registry = GetRegistry();
+	auto it = registry.find(name);
+	if (it != registry.end()) {
+		m_Index = it->second;
+		return;
+	}
+
+	m_Index = (unsigned int)GetNames().size();
+	GetNames().push_back(name);
+	registry.emplace(name, m_Index);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* A uniform name interned into a small dense index.
+ * Interning hashes the name once; after that every Shader looks the location up in a flat table by index.
+ * Keep IDs for per-frame uniforms around (eg. as statics) so the render loop never builds or hashes a string.
+ * The constructors are explicit so a string can't turn into an ID (and intern on every call) without it showing.
+ */
+class UniformID {
+private:
+	unsigned int m_Index;
+
+	static std::unordered_map<std::string, unsigned int>& GetRegistry();
+	static std::vector<std::string>& GetNames();
+
+public:
+	explicit UniformID(const char* name);
+	explicit UniformID(const std::string& name);
+
+	inline unsigned int GetIndex() const { return m_Index; }
+	inline const std::string& GetName() const { return GetNames()[m_Index]; }
+
+	/* Number of names interned so far. Location tables are sized from this */
+	static unsigned int GetCount() { return (unsigned int)GetNames().size(); }
+};
@@ -0,0 +1,133 @@
+#include "UniformRingBuffer.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+UniformRingBuffer::UniformRingBuffer(unsigned int frameSize)
+	: m_RendererID(0), m_Alignment(256), m_FrameSize(0), m_Frame(0), m_Head(0), m_Mapped(nullptr) {
+	int alignment = 0;
+	GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+	if (alignment > 0) {
+		m_Alignment = alignment;
+	}
+	/* Keep every segment start aligned too */
+	m_FrameSize = (frameSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+	for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++) {
+		m_Fences[i] = nullptr;
+	}
+
+	unsigned int totalSize = m_FrameSize * FRAMES_IN_FLIGHT;
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	if (GLEW_ARB_buffer_storage) {
+		/* Mapped once for the buffer's lifetime, so Write is a plain memcpy */
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags));
+		GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+	}
+	else {
+		GLCall(glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+UniformRingBuffer::~UniformRingBuffer() {
+	Release();
+}
+
+UniformRingBuffer::UniformRingBuffer(UniformRingBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Alignment(other.m_Alignment), m_FrameSize(other.m_FrameSize),
+	m_Frame(other.m_Frame), m_Head(other.m_Head), m_Mapped(other.m_Mapped) {
+	for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++) {
+		m_Fences[i] = other.m_Fences[i];
+		other.m_Fences[i] = nullptr;
+	}
+	other.m_RendererID = 0;
+	other.m_FrameSize = 0;
+	other.m_Head = 0;
+	other.m_Mapped = nullptr;
+}
+
+UniformRingBuffer& UniformRingBuffer::operator=(UniformRingBuffer&& other) noexcept {
+	if (this != &other) {
+		Release();
+		m_RendererID = other.m_RendererID;
+		m_Alignment = other.m_Alignment;
+		m_FrameSize = other.m_FrameSize;
+		m_Frame = other.m_Frame;
+		m_Head = other.m_Head;
+		m_Mapped = other.m_Mapped;
+		for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++) {
+			m_Fences[i] = other.m_Fences[i];
+			other.m_Fences[i] = nullptr;
+		}
+		other.m_RendererID = 0;
+		other.m_FrameSize = 0;
+		other.m_Head = 0;
+		other.m_Mapped = nullptr;
+	}
+	return *this;
+}
+
+/* No GL calls, so it's safe without a context. Without a Shutdown() first the mapping goes with the buffer, as
+ * deleting a mapped buffer unmaps it */
+void UniformRingBuffer::Release() {
+	for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++) {
+		DeletionQueue::Enqueue(m_Fences[i]);
+		m_Fences[i] = nullptr;
+	}
+	m_Mapped = nullptr;
+	DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+	m_RendererID = 0;
+}
+
+void UniformRingBuffer::Shutdown() {
+	if (m_Mapped) {
+		GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+		GLCall(glUnmapBuffer(GL_UNIFORM_BUFFER));
+		m_Mapped = nullptr;
+	}
+}
+
+void UniformRingBuffer::BeginFrame() {
+	m_Frame = (m_Frame + 1) % FRAMES_IN_FLIGHT;
+	m_Head = 0;
+
+	GLsync fence = m_Fences[m_Frame];
+	if (fence) {
+		/* Only blocks if the CPU is more than FRAMES_IN_FLIGHT frames ahead */
+		GLCall(GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED));
+		ASSERT(result != GL_WAIT_FAILED);
+		GLCall(glDeleteSync(fence));
+		m_Fences[m_Frame] = nullptr;
+	}
+}
+
+void UniformRingBuffer::EndFrame() {
+	GLCall(m_Fences[m_Frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+unsigned int UniformRingBuffer::Write(const void* data, unsigned int size) {
+	unsigned int aligned = (m_Head + m_Alignment - 1) / m_Alignment * m_Alignment;
+	if (aligned + size > m_FrameSize) {
+		/* Wrapping would overwrite blocks this frame's earlier draws still read */
+		std::cout << "Uniform ring buffer full: " << m_FrameSize << " bytes per frame" << std::endl;
+		ASSERT(false);
+		return m_Frame * m_FrameSize;
+	}
+
+	unsigned int offset = m_Frame * m_FrameSize + aligned;
+	if (m_Mapped) {
+		memcpy(m_Mapped + offset, data, size);
+	}
+	else {
+		GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+		GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+	}
+	m_Head = aligned + size;
+	return offset;
+}
+
+void UniformRingBuffer::BindRange(unsigned int binding, unsigned int offset, unsigned int size) const {
+	GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, offset, size));
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+
+/* One big GL_UNIFORM_BUFFER used as a linear allocator for per-draw data (transforms, colours).
+ * Each draw appends its block at the next GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT boundary and binds just
+ * that range with glBindBufferRange, so per-object constants cost a memcpy and a range bind.
+ * The buffer is split into one segment per frame in flight. A segment is only reused once its fence
+ * shows the GPU has finished the frame that read it.
+ */
+class UniformRingBuffer {
+private:
+	static const unsigned int FRAMES_IN_FLIGHT = 3;
+
+	unsigned int m_RendererID;
+	unsigned int m_Alignment;
+	unsigned int m_FrameSize;
+	unsigned int m_Frame;
+	unsigned int m_Head;
+	/* Persistent mapping when GL_ARB_buffer_storage is available, otherwise nullptr and we glBufferSubData */
+	unsigned char* m_Mapped;
+	GLsync m_Fences[FRAMES_IN_FLIGHT];
+
+	void Release();
+
+public:
+	UniformRingBuffer(unsigned int frameSize);
+	~UniformRingBuffer();
+	/* Move-only. The mapping and fences go with the buffer, a moved-from ring holds nothing */
+	UniformRingBuffer(UniformRingBuffer&& other) noexcept;
+	UniformRingBuffer& operator=(UniformRingBuffer&& other) noexcept;
+	UniformRingBuffer(const UniformRingBuffer&) = delete;
+	UniformRingBuffer& operator=(const UniformRingBuffer&) = delete;
+
+	/* Waits until the GPU is done with this frame's segment, then starts writing at its beginning */
+	void BeginFrame();
+	void EndFrame();
+	/* Unmaps the buffer while the context is still there. Nothing can be written after this */
+	void Shutdown();
+
+	/* Copies size bytes in and returns the offset to bind */
+	unsigned int Write(const void* data, unsigned int size);
+	void BindRange(unsigned int binding, unsigned int offset, unsigned int size) const;
+};
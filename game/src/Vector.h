@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cmath>
+
+/* Small vector types. Plain floats with no padding, except Vec4, which is 16 byte aligned so it loads straight
+ * into an SSE register and matches a std140 vec4. The heavy lifting is done on Mat4 and the batch functions in
+ * TransformBatch.h, these are just for building their inputs.
+ */
+struct Vec2 {
+	float x, y;
+};
+
+struct Vec3 {
+	float x, y, z;
+};
+
+struct alignas(16) Vec4 {
+	float x, y, z, w;
+};
+
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return { a.x + b.x, a.y + b.y }; }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return { a.x - b.x, a.y - b.y }; }
+inline Vec2 operator*(const Vec2& a, float s) { return { a.x * s, a.y * s }; }
+inline Vec2 operator*(const Vec2& a, const Vec2& b) { return { a.x * b.x, a.y * b.y }; }
+inline float Dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float Length(const Vec2& a) { return std::sqrt(Dot(a, a)); }
+inline Vec2 Normalize(const Vec2& a) { return a * (1.0f / Length(a)); }
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator-(const Vec3& a) { return { -a.x, -a.y, -a.z }; }
+inline Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+inline Vec3 operator*(const Vec3& a, const Vec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b) {
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline float Length(const Vec3& a) { return std::sqrt(Dot(a, a)); }
+inline Vec3 Normalize(const Vec3& a) { return a * (1.0f / Length(a)); }
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+inline Vec4 operator*(const Vec4& a, float s) { return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+inline Vec4 operator*(const Vec4& a, const Vec4& b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline float Length(const Vec4& a) { return std::sqrt(Dot(a, a)); }
+inline Vec4 Normalize(const Vec4& a) { return a * (1.0f / Length(a)); }
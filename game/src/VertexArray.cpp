@@ -10,8 +10,26 @@ VertexArray::VertexArray() {
 }
 
 VertexArray::~VertexArray() {
+	Release();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID) {
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
+	if (this != &other) {
+		Release();
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
 
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+void VertexArray::Release() {
+	DeletionQueue::Enqueue(VERTEX_ARRAY_OBJECT, m_RendererID);
+	m_RendererID = 0;
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout) {
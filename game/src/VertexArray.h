@@ -6,12 +6,19 @@
 /* Forward declare instead of including. Included in CPP file */
 class VertexBufferLayout;
 
+/* Move-only, a moved-from array holds 0. The attribute setup lives in the GL object, so it moves with it */
 class VertexArray {
 private:
 	unsigned int m_RendererID;
+
+	void Release();
 public:
 	VertexArray();
 	~VertexArray();
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
@@ -9,7 +9,26 @@ VertexBuffer::VertexBuffer(const void* data, unsigned int size) {
 }
 
 VertexBuffer::~VertexBuffer() {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	Release();
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID) {
+	other.m_RendererID = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept {
+	if (this != &other) {
+		Release();
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+void VertexBuffer::Release() {
+	DeletionQueue::Enqueue(BUFFER_OBJECT, m_RendererID);
+	m_RendererID = 0;
 }
 
 void VertexBuffer::Bind() const {
@@ -1,11 +1,18 @@
 #pragma once
 
+/* Owns its GL buffer, so it can be moved but not copied. A moved-from buffer holds 0 and deletes nothing */
 class VertexBuffer {
 private:
 	unsigned int m_RendererID;
+
+	void Release();
 public:
 	VertexBuffer(const void* data, unsigned int size);
 	~VertexBuffer();
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
 
 	void Bind() const;
 	void Unbind() const;
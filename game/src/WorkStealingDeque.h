@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+/* Chase-Lev deque (with the memory orderings from Le et al., "Correct and Efficient Work-Stealing for Weak
+ * Memory Models"). One owner thread pushes and pops at the bottom, like a stack, so it keeps working on what it
+ * queued most recently while that's still in cache. Any other thread may steal from the top, taking the oldest
+ * item, which for divide and conquer work is the biggest. Only the last item is ever contended.
+ * The buffer grows when full. Old buffers are kept until the deque is destroyed because a thief may still be
+ * reading one.
+ */
+template<typename T>
+class WorkStealingDeque {
+private:
+	struct Buffer {
+		long long Capacity;   /* Power of two */
+		std::atomic<T*>* Items;
+
+		Buffer(long long capacity)
+			: Capacity(capacity), Items(new std::atomic<T*>[(size_t)capacity]) {
+		}
+		~Buffer() { delete[] Items; }
+
+		inline T* Get(long long i) const { return Items[i & (Capacity - 1)].load(std::memory_order_relaxed); }
+		inline void Put(long long i, T* item) { Items[i & (Capacity - 1)].store(item, std::memory_order_relaxed); }
+	};
+
+	std::atomic<long long> m_Top;
+	std::atomic<long long> m_Bottom;
+	std::atomic<Buffer*> m_Buffer;
+	std::vector<Buffer*> m_Retired;
+
+	Buffer* Grow(Buffer* buffer, long long bottom, long long top) {
+		Buffer* grown = new Buffer(buffer->Capacity * 2);
+		for (long long i = top; i < bottom; i++) {
+			grown->Put(i, buffer->Get(i));
+		}
+		m_Retired.push_back(buffer);
+		m_Buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+public:
+	WorkStealingDeque(long long capacity = 256)
+		: m_Top(0), m_Bottom(0), m_Buffer(new Buffer(capacity)) {
+	}
+
+	~WorkStealingDeque() {
+		delete m_Buffer.load();
+		for (Buffer* buffer : m_Retired) {
+			delete buffer;
+		}
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	/* Owner only */
+	void Push(T* item) {
+		long long bottom = m_Bottom.load(std::memory_order_relaxed);
+		long long top = m_Top.load(std::memory_order_acquire);
+		Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+		if (bottom - top > buffer->Capacity - 1) {
+			buffer = Grow(buffer, bottom, top);
+		}
+		buffer->Put(bottom, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	/* Owner only. nullptr when empty */
+	T* Pop() {
+		long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		T* item = buffer->Get(bottom);
+		if (top == bottom) {
+			/* Last item, race any thief for it */
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				item = nullptr;
+			}
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	/* Any thread. nullptr when empty or when another thread won the race for the item */
+	T* Steal() {
+		long long top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long bottom = m_Bottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return nullptr;
+		}
+		Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+		T* item = buffer->Get(top);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return item;
+	}
+
+	/* A hint only, it may be out of date by the time it's returned */
+	inline bool IsEmpty() const {
+		return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+	}
+};
@@ -0,0 +1,104 @@
+#include "Embed.h"
+#include "Output.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+
+/* MSVC caps a single string literal at 16KB, adjacent literals are joined up to 64KB */
+static const size_t MAX_LITERAL_CHUNK = 8 * 1024;
+static const size_t MAX_LITERAL_SIZE = 64 * 1024 - 1;
+
+static bool WriteLiteral(std::ostream& out, const std::string& text, const std::string& name) {
+	if (text.find(")shader\"") != std::string::npos) {
+		std::cout << "shadertool: " << name << " contains the raw string delimiter )shader\"" << std::endl;
+		return false;
+	}
+	if (text.size() > MAX_LITERAL_SIZE) {
+		std::cout << "shadertool: " << name << " is too big to embed (" << text.size() << " bytes)" << std::endl;
+		return false;
+	}
+	if (text.empty()) {
+		out << "\t\t\"\"";
+		return true;
+	}
+
+	/* Split on line boundaries so each chunk stays under the per literal limit */
+	size_t begin = 0;
+	while (begin < text.size()) {
+		size_t end = std::min(begin + MAX_LITERAL_CHUNK, text.size());
+		if (end < text.size()) {
+			size_t newline = text.rfind('\n', end - 1);
+			if (newline != std::string::npos && newline >= begin) {
+				end = newline + 1;
+			}
+		}
+		out << "\t\tR\"shader(" << text.substr(begin, end - begin) << ")shader\"";
+		begin = end;
+		if (begin < text.size()) {
+			out << '\n';
+		}
+	}
+	return true;
+}
+
+int Embed(const std::string& directory, const std::string& output) {
+	std::vector<std::string> paths = FindShaderFiles(directory);
+
+	std::vector<ShaderProgramSource> sources;
+	for (const std::string& path : paths) {
+		ShaderPreprocessor preprocessor({});
+		sources.push_back(preprocessor.Process(path));
+		/* Errors were printed as file(line), which is all the build output needs */
+		if (!preprocessor.GetErrors().empty()) {
+			return 1;
+		}
+	}
+
+	std::stringstream out;
+	out << "/* Generated by shadertool embed from " << directory << ". Don't edit, edit the .shader files */\n";
+	out << "#pragma once\n\n";
+	out << "#include \"../EmbeddedShader.h\"\n\n";
+
+	/* Explicit uniform locations, one array per shader that has any */
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!sources[i].UniformLocations.empty()) {
+			out << "inline constexpr EmbeddedUniformLocation s_EmbeddedUniformLocations" << i << "[] = {\n";
+			for (const ShaderUniformLocation& location : sources[i].UniformLocations) {
+				out << "\t{ \"" << location.Name << "\", " << location.Location << " },\n";
+			}
+			out << "};\n\n";
+		}
+	}
+
+	out << "inline constexpr EmbeddedShader s_EmbeddedShaders[] = {\n";
+	for (size_t i = 0; i < sources.size(); i++) {
+		const std::string& path = paths[i];
+		out << "\t{\n\t\t\"" << path << "\",\n\t\t{\n";
+		for (unsigned int stage = 0; stage < SHADER_STAGE_COUNT; stage++) {
+			if (!WriteLiteral(out, sources[i].Sources[stage], path + " " + ShaderParser::GetStageName((ShaderStage)stage))) {
+				return 1;
+			}
+			out << ",\n";
+		}
+		out << "\t\t},\n";
+		if (sources[i].UniformLocations.empty()) {
+			out << "\t\tnullptr, 0\n";
+		}
+		else {
+			out << "\t\ts_EmbeddedUniformLocations" << i << ", " << sources[i].UniformLocations.size() << "\n";
+		}
+		out << "\t},\n";
+	}
+	if (paths.empty()) {
+		/* Zero length arrays aren't allowed. FindEmbeddedShader never matches an empty path */
+		out << "\t{ \"\", {}, nullptr, 0 }\n";
+	}
+	out << "};\n\n";
+	out << "inline constexpr size_t s_EmbeddedShaderCount = " << paths.size() << ";\n";
+
+	return WriteIfChanged(output, out.str()) ? 0 : 1;
+}
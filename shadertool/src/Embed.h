@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+/* shadertool embed <shader directory> <output header>
+ * Preprocesses every .shader file in the directory (includes resolved, no defines) and writes its stages as
+ * raw string literals into a header the game compiles in. See game/src/EmbeddedShader.h.
+ */
+int Embed(const std::string& directory, const std::string& output);
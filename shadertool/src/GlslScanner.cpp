@@ -0,0 +1,174 @@
+#include "GlslScanner.h"
+
+#include <cctype>
+#include <cstdlib>
+
+static bool IsIdentifierChar(char c) {
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+/* Identifiers, numbers and single punctuation characters, with comments and # lines dropped */
+static std::vector<std::string_view> Tokenise(std::string_view source) {
+	std::vector<std::string_view> tokens;
+	size_t i = 0;
+	bool lineStart = true;
+	while (i < source.size()) {
+		char c = source[i];
+		if (c == '\n') {
+			lineStart = true;
+			i++;
+		}
+		else if (isspace((unsigned char)c)) {
+			i++;
+		}
+		else if (c == '#' && lineStart) {
+			while (i < source.size() && source[i] != '\n') {
+				i++;
+			}
+		}
+		else if (source.compare(i, 2, "//") == 0) {
+			while (i < source.size() && source[i] != '\n') {
+				i++;
+			}
+		}
+		else if (source.compare(i, 2, "/*") == 0) {
+			size_t end = source.find("*/", i + 2);
+			i = end == std::string_view::npos ? source.size() : end + 2;
+		}
+		else if (IsIdentifierChar(c)) {
+			size_t begin = i;
+			while (i < source.size() && (IsIdentifierChar(source[i]) || source[i] == '.')) {
+				i++;
+			}
+			tokens.push_back(source.substr(begin, i - begin));
+			lineStart = false;
+		}
+		else {
+			tokens.push_back(source.substr(i, 1));
+			lineStart = false;
+			i++;
+		}
+	}
+	return tokens;
+}
+
+/* Index of the token after the } matching the { at open */
+static size_t SkipBraces(const std::vector<std::string_view>& tokens, size_t open) {
+	int depth = 0;
+	for (size_t i = open; i < tokens.size(); i++) {
+		if (tokens[i] == "{") {
+			depth++;
+		}
+		else if (tokens[i] == "}" && --depth == 0) {
+			return i + 1;
+		}
+	}
+	return tokens.size();
+}
+
+/* Everything about one statement that matters here */
+struct Statement {
+	int Location = -1;
+	bool Std140 = false;
+	bool Uniform = false;
+	bool In = false;
+	bool Function = false;
+	/* What's left once the layout and qualifiers are taken off: type then one or more names */
+	std::vector<std::string_view> Rest;
+};
+
+static Statement ParseStatement(const std::vector<std::string_view>& tokens, size_t begin, size_t end) {
+	Statement statement;
+	for (size_t i = begin; i < end; i++) {
+		std::string_view token = tokens[i];
+		if (token == "layout" && i + 1 < end && tokens[i + 1] == "(") {
+			for (i += 2; i < end && tokens[i] != ")"; i++) {
+				if (tokens[i] == "location" && i + 2 < end && tokens[i + 1] == "=") {
+					statement.Location = atoi(std::string(tokens[i + 2]).c_str());
+				}
+				else if (tokens[i] == "std140") {
+					statement.Std140 = true;
+				}
+			}
+		}
+		else if (token == "uniform") {
+			statement.Uniform = true;
+		}
+		else if (token == "in") {
+			statement.In = true;
+		}
+		else if (token == "(") {
+			statement.Function = true;
+		}
+		else if (token == "const" || token == "flat" || token == "smooth" || token == "noperspective" ||
+			token == "centroid" || token == "highp" || token == "mediump" || token == "lowp") {
+			continue;
+		}
+		else {
+			statement.Rest.push_back(token);
+		}
+	}
+	return statement;
+}
+
+/* "type name[N], name2;" as variables. Initialisers are ignored */
+static void AddVariables(const Statement& statement, std::vector<GlslVariable>& out) {
+	const std::vector<std::string_view>& rest = statement.Rest;
+	if (rest.size() < 2) {
+		return;
+	}
+	for (size_t i = 1; i < rest.size(); i++) {
+		if (rest[i] == "=") {
+			return;
+		}
+		/* Skips , [ ] and array sizes */
+		if (!IsIdentifierChar(rest[i][0]) || isdigit((unsigned char)rest[i][0])) {
+			continue;
+		}
+		GlslVariable variable = { std::string(rest[0]), std::string(rest[i]), 0, statement.Location };
+		if (i + 3 < rest.size() && rest[i + 1] == "[" && rest[i + 3] == "]") {
+			variable.ArraySize = (unsigned int)atoi(std::string(rest[i + 2]).c_str());
+		}
+		out.push_back(variable);
+	}
+}
+
+GlslDeclarations ScanDeclarations(std::string_view source) {
+	GlslDeclarations declarations;
+	std::vector<std::string_view> tokens = Tokenise(source);
+
+	size_t begin = 0;
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens[i] == ";") {
+			Statement statement = ParseStatement(tokens, begin, i);
+			if (!statement.Function) {
+				if (statement.Uniform) {
+					AddVariables(statement, declarations.Uniforms);
+				}
+				else if (statement.In) {
+					AddVariables(statement, declarations.Inputs);
+				}
+			}
+			begin = i + 1;
+		}
+		else if (tokens[i] == "{") {
+			Statement statement = ParseStatement(tokens, begin, i);
+			size_t end = SkipBraces(tokens, i);
+			if (statement.Uniform && !statement.Function && !statement.Rest.empty()) {
+				GlslBlock block = { std::string(statement.Rest[0]), statement.Std140, {} };
+				size_t memberBegin = i + 1;
+				for (size_t m = i + 1; m + 1 < end; m++) {
+					if (tokens[m] == ";") {
+						AddVariables(ParseStatement(tokens, memberBegin, m), block.Members);
+						memberBegin = m + 1;
+					}
+				}
+				declarations.UniformBlocks.push_back(block);
+			}
+			/* Function bodies, struct definitions and the block itself. An instance name and ; may follow */
+			i = end - 1;
+			begin = end;
+		}
+	}
+	return declarations;
+}
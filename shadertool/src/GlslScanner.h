@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* One declared variable: an attribute, a default block uniform or a block member */
+struct GlslVariable {
+	std::string Type;      /* GLSL type name, eg. "vec4" */
+	std::string Name;
+	unsigned int ArraySize; /* 0 for non arrays */
+	int Location;          /* From layout(location = N), -1 if not given */
+};
+
+struct GlslBlock {
+	std::string Name;
+	bool Std140;
+	std::vector<GlslVariable> Members;
+};
+
+struct GlslDeclarations {
+	std::vector<GlslVariable> Inputs;     /* "in" at global scope, attributes for a vertex stage */
+	std::vector<GlslVariable> Uniforms;   /* Default block */
+	std::vector<GlslBlock> UniformBlocks;
+};
+
+/* Finds the global declarations in one preprocessed stage without a GL context. Comments and preprocessor lines
+ * are skipped and function bodies are stepped over, so only what a driver's reflection would report is kept,
+ * except that #if'd out declarations are still seen (shadertool reflects the no-defines variant).
+ */
+GlslDeclarations ScanDeclarations(std::string_view source);
@@ -0,0 +1,44 @@
+#include "Output.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool WriteIfChanged(const std::string& path, const std::string& contents) {
+	std::ifstream existing(path, std::ios::binary);
+	if (existing) {
+		std::stringstream current;
+		current << existing.rdbuf();
+		if (current.str() == contents) {
+			return true;
+		}
+	}
+	existing.close();
+
+	std::filesystem::path parent = std::filesystem::path(path).parent_path();
+	if (!parent.empty()) {
+		std::filesystem::create_directories(parent);
+	}
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out) {
+		std::cout << "shadertool: can't write '" << path << "'" << std::endl;
+		return false;
+	}
+	out << contents;
+	std::cout << "shadertool: wrote " << path << std::endl;
+	return true;
+}
+
+std::vector<std::string> FindShaderFiles(const std::string& directory) {
+	std::vector<std::string> paths;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".shader") {
+			paths.push_back(entry.path().generic_string());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
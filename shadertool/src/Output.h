@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/* Generated headers are only rewritten when their contents change, so an unchanged shader doesn't trigger a rebuild */
+bool WriteIfChanged(const std::string& path, const std::string& contents);
+
+/* Every .shader file directly in directory, sorted so the output doesn't depend on directory order */
+std::vector<std::string> FindShaderFiles(const std::string& directory);
@@ -0,0 +1,308 @@
+#include "Reflect.h"
+#include "GlslScanner.h"
+#include "Output.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+
+/* How a GLSL type sits in a std140 block, and what C++ type mirrors it */
+struct Std140Type {
+	const char* Glsl;
+	unsigned int Align;
+	unsigned int Size;
+	const char* Cpp;
+	unsigned int CppAlign;  /* The C++ type's own alignment and size, which can differ (vec3 is 16 in C++) */
+	unsigned int CppSize;
+	unsigned int Columns;   /* mat3 goes out as 3 Std140Vec4 columns, everything else 1 */
+};
+
+static const Std140Type s_Std140Types[] = {
+	{ "float", 4, 4, "float", 4, 4, 1 },
+	{ "int", 4, 4, "int", 4, 4, 1 },
+	{ "uint", 4, 4, "unsigned int", 4, 4, 1 },
+	{ "bool", 4, 4, "int", 4, 4, 1 },
+	{ "vec2", 8, 8, "Std140Vec2", 8, 8, 1 },
+	{ "vec3", 16, 12, "Std140Vec3", 16, 16, 1 },
+	{ "vec4", 16, 16, "Std140Vec4", 16, 16, 1 },
+	{ "mat3", 16, 48, "Std140Vec4", 16, 16, 3 },
+	{ "mat4", 16, 64, "Std140Mat4", 16, 64, 1 }
+};
+
+static const Std140Type* FindStd140Type(const std::string& glsl) {
+	for (const Std140Type& type : s_Std140Types) {
+		if (glsl == type.Glsl) {
+			return &type;
+		}
+	}
+	return nullptr;
+}
+
+static unsigned int AlignUp(unsigned int value, unsigned int alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/* u_ViewProjection -> ViewProjection */
+static std::string MemberName(const std::string& name) {
+	if (name.size() > 2 && name[1] == '_' && (name[0] == 'u' || name[0] == 'a')) {
+		return name.substr(2);
+	}
+	return name;
+}
+
+/* u_ViewProjection -> VIEW_PROJECTION */
+static std::string ConstantName(const std::string& name) {
+	std::string member = MemberName(name);
+	std::string constant;
+	for (size_t i = 0; i < member.size(); i++) {
+		char c = member[i];
+		if (i > 0 && isupper((unsigned char)c) && islower((unsigned char)member[i - 1])) {
+			constant += '_';
+		}
+		constant += (char)toupper((unsigned char)c);
+	}
+	return constant;
+}
+
+/* res/shaders/sprite_lit.shader -> SpriteLitShader */
+static std::string NamespaceName(const std::string& path) {
+	std::string stem = std::filesystem::path(path).stem().string();
+	std::string name;
+	bool upper = true;
+	for (char c : stem) {
+		if (!isalnum((unsigned char)c)) {
+			upper = true;
+			continue;
+		}
+		name += upper ? (char)toupper((unsigned char)c) : c;
+		upper = false;
+	}
+	return name + "Shader";
+}
+
+static bool SameVariables(const std::vector<GlslVariable>& a, const std::vector<GlslVariable>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].Type != b[i].Type || a[i].Name != b[i].Name || a[i].ArraySize != b[i].ArraySize) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* The block as a C++ struct, padded so every member lands on its std140 offset. False if it can't be */
+static bool WriteBlock(std::ostream& out, const GlslBlock& block, const std::string& path) {
+	if (!block.Std140) {
+		out << "\t/* " << block.Name << " isn't layout(std140), its offsets are up to the driver */\n";
+		return true;
+	}
+
+	std::stringstream members;
+	std::stringstream checks;
+	unsigned int offset = 0;       /* std140 */
+	unsigned int cppOffset = 0;    /* Where the C++ compiler will put the next member */
+	unsigned int cppAlign = 4;
+	unsigned int padding = 0;
+	for (const GlslVariable& member : block.Members) {
+		const Std140Type* type = FindStd140Type(member.Type);
+		if (!type) {
+			std::cout << path << ": error: " << block.Name << "::" << member.Name << " has type " << member.Type
+				<< ", which shadertool can't mirror" << std::endl;
+			return false;
+		}
+
+		/* Array elements are padded out to 16 bytes each */
+		bool array = member.ArraySize > 0;
+		unsigned int align = array ? 16 : type->Align;
+		unsigned int count = type->Columns * (array ? member.ArraySize : 1);
+		const char* cppType = type->Cpp;
+		unsigned int cppTypeAlign = type->CppAlign;
+		unsigned int cppTypeSize = type->CppSize;
+		if (array && type->CppSize < 16) {
+			cppType = "Std140Vec4";
+			cppTypeAlign = 16;
+			cppTypeSize = 16;
+		}
+		unsigned int size = array || type->Columns > 1 ? count * cppTypeSize : type->Size;
+
+		offset = AlignUp(offset, align);
+		cppOffset = AlignUp(cppOffset, cppTypeAlign);
+		if (offset < cppOffset) {
+			std::cout << path << ": error: " << block.Name << "::" << member.Name << " is packed into the end of the"
+				<< " member before it, which C++ can't do. Move it or pad the GLSL" << std::endl;
+			return false;
+		}
+		if (offset > cppOffset) {
+			members << "\t\tfloat Padding" << padding++ << "[" << (offset - cppOffset) / 4 << "];\n";
+		}
+
+		std::string name = MemberName(member.Name);
+		members << "\t\t" << cppType << " " << name;
+		if (count > 1 || array) {
+			members << "[" << count << "]";
+		}
+		members << ";";
+		if (cppType != std::string(type->Cpp) || type->Columns > 1) {
+			members << " /* " << member.Type << (array ? "[" + std::to_string(member.ArraySize) + "]" : "") << " */";
+		}
+		members << "\n";
+		checks << "\tSTD140_CHECK_OFFSET(" << block.Name << ", " << name << ", " << offset << ");\n";
+
+		offset += size;
+		cppOffset = offset + (count > 1 || array ? 0 : cppTypeSize - type->Size);
+		cppAlign = std::max(cppAlign, cppTypeAlign);
+	}
+
+	unsigned int blockSize = AlignUp(offset, 16);
+	cppOffset = AlignUp(cppOffset, cppAlign);
+	if (blockSize > cppOffset) {
+		members << "\t\tfloat Padding" << padding++ << "[" << (blockSize - cppOffset) / 4 << "];\n";
+	}
+
+	out << "\tstruct " << block.Name << " {\n" << members.str() << "\t};\n";
+	out << checks.str();
+	out << "\tSTD140_CHECK_BLOCK(" << block.Name << ", " << blockSize << ");\n";
+	return true;
+}
+
+/* Attributes in location order. VertexArray gives element i location i, so they have to run 0, 1, 2... */
+static void WriteVertexLayout(std::ostream& out, std::vector<GlslVariable> inputs, const std::string& path) {
+	std::sort(inputs.begin(), inputs.end(),
+		[](const GlslVariable& a, const GlslVariable& b) { return a.Location < b.Location; });
+
+	std::stringstream pushes;
+	for (unsigned int i = 0; i < inputs.size(); i++) {
+		const GlslVariable& input = inputs[i];
+		if (input.Location != (int)i) {
+			std::cout << path << ": warning: attribute locations aren't 0, 1, 2..., no vertex layout written" << std::endl;
+			return;
+		}
+
+		std::string type = input.Type;
+		unsigned int components = 1;
+		if (type.size() == 4 && type.compare(0, 3, "vec") == 0) {
+			components = type[3] - '0';
+			type = "float";
+		}
+		else if (type.size() == 5 && type.compare(0, 4, "uvec") == 0) {
+			components = type[4] - '0';
+			type = "uint";
+		}
+		if (type == "float") {
+			pushes << "\t\tlayout.Push<float>(" << components << ");\n";
+		}
+		else if (type == "uint") {
+			pushes << "\t\tlayout.Push<unsigned int>(" << components << ");\n";
+		}
+		else {
+			std::cout << path << ": warning: attribute " << input.Name << " is a " << input.Type
+				<< ", which VertexBufferLayout can't describe, no vertex layout written" << std::endl;
+			return;
+		}
+	}
+
+	out << "\t/* Component counts as declared. A mesh that feeds fewer (a vec2 into a vec4) needs its own */\n";
+	out << "\tinline VertexBufferLayout GetVertexLayout() {\n";
+	out << "\t\tVertexBufferLayout layout;\n" << pushes.str() << "\t\treturn layout;\n\t}\n";
+}
+
+int Reflect(const std::string& directory, const std::string& output) {
+	std::vector<std::string> paths = FindShaderFiles(directory);
+
+	/* Blocks are shared between shaders (they come from include files), so they're written once */
+	std::map<std::string, GlslBlock> blocks;
+	std::map<std::string, std::string> blockPaths;
+	std::stringstream shaders;
+	for (const std::string& path : paths) {
+		ShaderPreprocessor preprocessor({});
+		ShaderProgramSource source = preprocessor.Process(path);
+		if (!preprocessor.GetErrors().empty()) {
+			return 1;
+		}
+
+		GlslDeclarations program;
+		std::vector<std::string> programBlocks;
+		for (unsigned int stage = 0; stage < SHADER_STAGE_COUNT; stage++) {
+			if (source.Sources[stage].empty()) {
+				continue;
+			}
+			GlslDeclarations declarations = ScanDeclarations(source.Sources[stage]);
+			if (stage == VERTEX_STAGE) {
+				program.Inputs = declarations.Inputs;
+			}
+			for (const GlslVariable& uniform : declarations.Uniforms) {
+				auto existing = std::find_if(program.Uniforms.begin(), program.Uniforms.end(),
+					[&uniform](const GlslVariable& other) { return other.Name == uniform.Name; });
+				if (existing == program.Uniforms.end()) {
+					program.Uniforms.push_back(uniform);
+				}
+			}
+			for (const GlslBlock& block : declarations.UniformBlocks) {
+				auto existing = blocks.find(block.Name);
+				if (existing == blocks.end()) {
+					blocks.emplace(block.Name, block);
+					blockPaths.emplace(block.Name, path);
+				}
+				else if (!SameVariables(existing->second.Members, block.Members) || existing->second.Std140 != block.Std140) {
+					std::cout << path << ": error: uniform block " << block.Name
+						<< " is declared differently somewhere else. Shaders sharing it should include one file" << std::endl;
+					return 1;
+				}
+				if (std::find(programBlocks.begin(), programBlocks.end(), block.Name) == programBlocks.end()) {
+					programBlocks.push_back(block.Name);
+				}
+			}
+		}
+
+		shaders << "/* " << path << " */\n";
+		shaders << "namespace " << NamespaceName(path) << " {\n";
+		for (const GlslVariable& input : program.Inputs) {
+			if (input.Location != -1) {
+				shaders << "\tconstexpr unsigned int " << ConstantName(input.Name) << "_ATTRIBUTE = " << input.Location << ";\n";
+			}
+		}
+		for (const GlslVariable& uniform : program.Uniforms) {
+			shaders << "\tconstexpr const char* " << ConstantName(uniform.Name) << "_UNIFORM = \"" << uniform.Name << "\";\n";
+			if (uniform.Location != -1) {
+				shaders << "\tconstexpr int " << ConstantName(uniform.Name) << "_LOCATION = " << uniform.Location << ";\n";
+			}
+		}
+		for (const std::string& block : programBlocks) {
+			if (blocks[block].Std140) {
+				shaders << "\ttypedef ShaderBlocks::" << block << " " << block << ";\n";
+			}
+		}
+		if (!program.Inputs.empty()) {
+			WriteVertexLayout(shaders, program.Inputs, path);
+		}
+		shaders << "}\n\n";
+	}
+
+	std::stringstream out;
+	out << "/* Generated by shadertool reflect from " << directory << ". Don't edit, edit the .shader files */\n";
+	out << "#pragma once\n\n";
+	out << "#include \"../UniformBlocks.h\"\n";
+	out << "#include \"../VertexBufferLayout.h\"\n\n";
+	out << "/* Every std140 uniform block any shader declares, laid out to match the GLSL */\n";
+	out << "namespace ShaderBlocks {\n";
+	for (auto block = blocks.begin(); block != blocks.end(); block++) {
+		if (block != blocks.begin()) {
+			out << "\n";
+		}
+		if (!WriteBlock(out, block->second, blockPaths[block->first])) {
+			return 1;
+		}
+	}
+	out << "}\n\n";
+	out << shaders.str();
+
+	return WriteIfChanged(output, out.str()) ? 0 : 1;
+}
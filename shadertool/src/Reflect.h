@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+/* shadertool reflect <shader directory> <output header>
+ * Reads the attributes, uniforms and uniform blocks each .shader file declares and writes them out as C++:
+ * constexpr attribute and uniform locations, std140 mirrors of the blocks with their offsets static_assert'ed,
+ * and a VertexBufferLayout matching the vertex inputs. A shader edit that no longer matches the C++ built
+ * against it then fails to compile instead of drawing garbage.
+ */
+int Reflect(const std::string& directory, const std::string& output);
@@ -0,0 +1,21 @@
+#include <iostream>
+#include <string>
+
+#include "Embed.h"
+#include "Reflect.h"
+
+/* Build time helper for the game project, run from its pre-build step in the game project directory */
+int main(int argc, char** argv) {
+	std::string command = argc > 1 ? argv[1] : "";
+
+	if (command == "embed" && argc == 4) {
+		return Embed(argv[2], argv[3]);
+	}
+	if (command == "reflect" && argc == 4) {
+		return Reflect(argv[2], argv[3]);
+	}
+
+	std::cout << "usage: shadertool embed <shader directory> <output header>" << std::endl;
+	std::cout << "       shadertool reflect <shader directory> <output header>" << std::endl;
+	return 1;
+}